@@ -28,6 +28,7 @@ struct Settings {
 		bool debugDisableStrategicView = false;
 		bool debugSpatialPartitioning = false;
 		bool debugSpatialPartitioningPlanetoids = false;
+		bool debugSpeedLabels = false;
 		bool useShadow = true;
 		bool multiViewports = false;
 	} render;
@@ -35,7 +36,16 @@ struct Settings {
 			struct {
 					bool dotsRepresentSpeed = true;
 			} orbits;
+			bool staticScheduler = false; // Dispatch processes statically instead of through function pointers, read at star system init
+			bool deterministic = false; // Integer and fixed point math for movement and orbits so results are bit identical between builds and machines
 	} systems;
+	struct {
+		bool pinWorkers = false; // Pin starsystem workers to cores and keep each system on its home worker
+		float rebalanceSkew = 1.5; // Move a system to another worker when the slowest worker is this much slower than the average
+		bool nonBlockingPromotion = false; // Skip the galaxy shadow swap while the UI holds its lock instead of waiting, star system shadows never wait on the UI
+		uint32_t parallelShadowSync = 5000; // Copy each synced component to the shadow on its own job in star systems with at least this many entities
+		float packedShadowSync = 0.25; // Copy a whole synced component pool to the shadow when at least this fraction of it changed
+	} galaxy;
 };
 
 struct Assets {
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <thread>
+#include <fmt/core.h>
 
 #include <Interface/WindowImpl.h>
 
@@ -10,6 +11,9 @@
 #include <log4cxx/helpers/exception.h>
 
 #include "galaxy/Galaxy.hpp"
+#include "starsystems/StarSystem.hpp"
+#include "starsystems/ShadowStarSystem.hpp"
+#include "starsystems/components/Components.hpp"
 #include "ui/AuroraWindow.hpp"
 #include "ui/starsystem/StarSystemLayer.hpp"
 #include "ui/imgui/ImGuiLayer.hpp"
@@ -103,6 +107,9 @@ PFN_vkGetRandROutputDisplayEXT vk_GetRandROutputDisplayEXT = VK_NULL_HANDLE;
 
 std::thread* vsyncThread = nullptr;
 void vsyncWorker(VkDisplayKHR vkDisplay);
+uint64_t simulateHeadless(uint32_t ticks);
+void benchmarkTicks(uint32_t ticks);
+void benchmarkShadow(uint32_t entities);
 
 int main(int argc, char **argv) {
 	tracy::StartupProfiler();
@@ -114,6 +121,42 @@ int main(int argc, char **argv) {
 	LoggerPtr log = Logger::getLogger("aurora");
 	LOG4CXX_FATAL(log, "### Starting ###");
 	
+	// --verify-determinism <ticks> [hash]: runs the test system twice in the deterministic mode and prints the hash of the resulting state.
+	//  Pass the hash printed by another build or machine to compare against it, drift between builds does not show up within one process.
+	for (int i = 1; i + 1 < argc; i++) {
+		if (string_view(argv[i]) == "--verify-determinism") {
+			uint32_t ticks = stoul(argv[i + 1]);
+			Aurora.settings.systems.deterministic = true;
+			
+			uint64_t hash1 = simulateHeadless(ticks);
+			uint64_t hash2 = simulateHeadless(ticks);
+			bool identical = hash1 == hash2;
+			
+			cout << "determinism " << ticks << " ticks: " << hex << hash1 << " " << hash2 << (identical ? " identical" : " DIFFERENT") << dec << endl;
+			
+			if (i + 2 < argc) {
+				uint64_t expected = stoull(argv[i + 2], nullptr, 16);
+				identical = identical && hash1 == expected;
+				
+				cout << "expected " << hex << expected << (hash1 == expected ? " identical" : " DIFFERENT") << dec << endl;
+			}
+			
+			return identical ? 0 : 1;
+		}
+		
+		// --benchmark-ticks <ticks>: tick time of 1, 8 and 64 test systems on one worker and on all cores
+		if (string_view(argv[i]) == "--benchmark-ticks") {
+			benchmarkTicks(stoul(argv[i + 1]));
+			return 0;
+		}
+		
+		// --benchmark-shadow <entities>: shadow component sync time per entity and copy strategy for different fractions of changed entities
+		if (string_view(argv[i]) == "--benchmark-shadow") {
+			benchmarkShadow(stoul(argv[i + 1]));
+			return 0;
+		}
+	}
+	
 //	cout <<  "starting network" << endl << flush;
 //	
 //	Aurora.network = new Network();
@@ -313,6 +356,15 @@ int main(int argc, char **argv) {
 				Aurora.network->receive(); //TODO move to its own thread inside network
 			}
 			
+			// Star system shadows only advance here. The frame handles then keep input handling and every window on the same tick
+			//  until the frame is done, handles taken further down pin the same shadows.
+			std::deque<ShadowHandle> frameShadows;
+			
+			for (StarSystem* system : Aurora.galaxy->systems) {
+				system->promoteShadow();
+				frameShadows.emplace_back(*system);
+			}
+			
 			Aurora.vk2dInstance->Run();
 			
 			for (AuroraWindow* window : Aurora.windows) {
@@ -408,6 +460,123 @@ int main(int argc, char **argv) {
 		// https://www.khronos.org/registry/vulkan/specs/1.2-extensions/man/html/VK_EXT_display_surface_counter.html
 		// using OpenXR https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#frame-synchronization
 
+// Same setup as main without any windows, with engines and move orders for the test ships so movement is exercised
+Galaxy* createHeadlessGalaxy(uint32_t systemCount) {
+	vector<StarSystem*> starSystems;
+	for (uint32_t i = 0; i < systemCount; i++) {
+		starSystems.push_back(new StarSystem(fmt::format("test{}", i)));
+	}
+	
+	vector<Empire> empires { Empire("gaia"), Empire("player1") };
+	vector<Player> players { Player("local") };
+	Galaxy* galaxy = new Galaxy(empires, starSystems, players);
+	Aurora.galaxy = galaxy;
+	
+	galaxy->initHeadless();
+	
+	for (StarSystem* system : galaxy->systems) {
+		entt::registry& registry = system->registry;
+		entt::entity planet = registry.view<OrbitComponent>().front();
+		uint32_t i = 0;
+		
+		for (entt::entity ship : registry.view<ShipComponent>()) {
+			ThrustComponent& thrust = registry.emplace<ThrustComponent>(ship);
+			thrust.thrust = 10000;
+			thrust.maxThrust = 10000;
+			
+			switch (i++ % 3) {
+				case 0: registry.emplace<MoveToEntityComponent>(ship, planet, ApproachType::BRACHISTOCHRONE); break;
+				case 1: registry.emplace<MoveToPositionComponent>(ship, Vector2l { 0, 0 }, ApproachType::BRACHISTOCHRONE); break;
+				case 2: registry.emplace<MoveToEntityComponent>(ship, planet, ApproachType::BALLISTIC); break;
+			}
+		}
+	}
+	
+	return galaxy;
+}
+
+void destroyHeadlessGalaxy(Galaxy* galaxy) {
+	if (Aurora.galaxy == galaxy) {
+		Aurora.galaxy = nullptr;
+	}
+	
+	delete galaxy;
+}
+
+uint64_t simulateHeadless(uint32_t ticks) {
+	Galaxy* galaxy = createHeadlessGalaxy(1);
+	uint64_t hash = galaxy->simulate(ticks);
+	destroyHeadlessGalaxy(galaxy);
+	return hash;
+}
+
+void benchmarkTicks(uint32_t ticks) {
+	uint32_t cores = std::max(std::thread::hardware_concurrency(), 1U);
+	
+	for (uint32_t systemCount : { 1, 8, 64 }) {
+		for (uint32_t workers : { 1U, cores }) {
+			Galaxy* galaxy = createHeadlessGalaxy(systemCount);
+			
+			nanoseconds start = getNanos();
+			galaxy->simulate(ticks, workers);
+			nanoseconds duration = getNanos() - start;
+			
+			cout << fmt::format("{:>2} systems, {:>2} workers: {:>8.1f}us per tick, {} jobs stolen", systemCount, workers, duration.count() / 1000.0 / ticks, galaxy->jobs.getStolenCount()) << endl;
+			destroyHeadlessGalaxy(galaxy);
+		}
+	}
+}
+
+// Updates the same working shadow repeatedly so that only the component copies are measured
+void benchmarkShadow(uint32_t entities) {
+	constexpr uint32_t rounds = 100;
+	Aurora.settings.galaxy.parallelShadowSync = std::numeric_limits<uint32_t>::max();
+	
+	Galaxy* galaxy = createHeadlessGalaxy(1);
+	StarSystem* system = galaxy->systems[0];
+	entt::registry& registry = system->registry;
+	
+	for (uint32_t i = 0; i < entities; i++) {
+		entt::entity entity = registry.create();
+		registry.emplace<TimedMovementComponent>(entity);
+		registry.emplace<CircleComponent>(entity);
+	}
+	
+	system->workingShadow->update();
+	system->workingShadow->added.clear();
+	
+	auto view = registry.view<TimedMovementComponent>();
+	
+	for (float fraction : { 0.01f, 0.1f, 0.5f, 1.0f }) {
+		system->workingShadow->changed.clear();
+		for (HierarchicalBitVector& bitVector : system->workingShadow->changedComponents) {
+			bitVector.clear();
+		}
+		
+		uint32_t changed = 0;
+		for (entt::entity entity : view) {
+			if (changed++ >= view.size() * fraction) {
+				break;
+			}
+			system->changed<TimedMovementComponent, CircleComponent>(entity);
+		}
+		
+		for (bool packed : { false, true }) {
+			Aurora.settings.galaxy.packedShadowSync = packed ? 0 : std::numeric_limits<float>::infinity();
+			
+			nanoseconds start = getNanos();
+			for (uint32_t round = 0; round < rounds; round++) {
+				system->workingShadow->update();
+			}
+			nanoseconds duration = getNanos() - start;
+			
+			cout << fmt::format("{} entities, {:>3.0f}% changed, {:>6}: {:>8.1f}us per sync", view.size(), fraction * 100, packed ? "packed" : "sparse", duration.count() / 1000.0 / rounds) << endl;
+		}
+	}
+	
+	destroyHeadlessGalaxy(galaxy);
+}
+
 nanoseconds lastVsync = getNanos();
 void vsyncWorker(VkDisplayKHR vkDisplay) {
 	
@@ -10,10 +10,20 @@
 
 #include <Tracy.hpp>
 
+#include "Aurora.hpp"
 #include "Galaxy.hpp"
 #include "utils/Math.hpp"
 #include "utils/Format.hpp"
 
+Galaxy::~Galaxy() {
+	for (StarSystem* system : systems) {
+		delete system;
+	}
+	
+	delete shadow;
+	delete workingShadow;
+}
+
 void Galaxy::init() {
 	LOG4CXX_INFO(log, "initializing galaxy");
 
@@ -23,23 +33,91 @@ void Galaxy::init() {
 	
 	updateSpeed();
 	
-	takenWorkCounter = systems.size();
-	completedWorkCounter = systems.size();
-	
 	uint32_t cores = std::thread::hardware_concurrency();
 	if (cores < 1) {
 		LOG4CXX_WARN(log, "Unable to determine core count!");
 		cores = 1;
 	}
 	
+	jobs.init(cores);
+	tickBarrier.init(cores);
+	
 	for (uint32_t i = 0; i < cores; i++) {
-		std::thread *workerThread = new std::thread(&Galaxy::starsystemWorker, this);
+		std::thread *workerThread = new std::thread(&Galaxy::starsystemWorker, this, i);
 		threads.push_back(workerThread);
+		
+		if (Aurora.settings.galaxy.pinWorkers) {
+			setThreadAffinity(*workerThread, i);
+		}
+	}
+	
+	for (uint32_t i = 0; i < systems.size(); i++) {
+		systems[i]->homeWorker = i % cores;
 	}
 
 	galaxyThread = new std::thread(&Galaxy::galaxyWorker, this);
 }
 
+void Galaxy::initHeadless() {
+	for (StarSystem* system : systems) {
+		system->init(this);
+	}
+}
+
+uint64_t Galaxy::simulate(uint32_t ticks, uint32_t workerCount) {
+	jobs.init(workerCount);
+	
+	std::atomic<bool> done = false;
+	std::vector<std::thread> workers;
+	
+	for (uint32_t i = 1; i < workerCount; i++) {
+		workers.emplace_back([this, i, &done]() {
+			JobSystem::setWorker(i);
+			
+			while (true) {
+				// Before checking done, otherwise the wakeAll after done is set can be missed and we park forever
+				uint32_t generation = jobs.getGeneration();
+				
+				if (done.load(std::memory_order_relaxed)) {
+					break;
+				}
+				
+				if (!jobs.runOne()) {
+					jobs.waitForJobs(generation);
+				}
+			}
+		});
+	}
+	
+	JobSystem::setWorker(0);
+	
+	for (uint32_t tick = 0; tick < ticks; tick++) {
+		std::atomic<uint32_t> remaining = systems.size();
+		
+		for (uint32_t i = 0; i < systems.size(); i++) {
+			jobs.push(Job { &Galaxy::simulateSystem, this, i, &remaining });
+		}
+		
+		jobs.help(remaining);
+		time += tickSize;
+	}
+	
+	done = true;
+	jobs.wakeAll();
+	
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	
+	uint64_t hash = 0;
+	
+	for (StarSystem* system : systems) {
+		hash = hash * 31 + system->hashState();
+	}
+	
+	return hash;
+}
+
 void Galaxy::galaxyWorker() {
 	tracy::SetThreadName("galaxy-worker");
 	
@@ -52,6 +130,10 @@ void Galaxy::galaxyWorker() {
 		nanoseconds oldSpeed = speed;
 		nanoseconds lastSleep = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch());
 		nanoseconds lastProcess = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch());
+		nanoseconds lastRunDuration = 0ns;
+		nanoseconds lastTickDuration = 0ns;
+		nanoseconds lastSpeedSample = lastProcess;
+		uint64_t lastSpeedSampleTime = time;
 		
 		while (!shutdown) {
 			nanoseconds now = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch());
@@ -61,19 +143,14 @@ void Galaxy::galaxyWorker() {
 				if (speed != oldSpeed) {
 					accumulator = 0ns;
 					oldSpeed = speed;
+					lastTickDuration = 0ns; // Start over from the baseline tick size
 				} else {
 					accumulator += now - lastSleep;
 				}
 				
 				if (accumulator >= speed) {
-
-					//TODO automatically adjust based on computer speed
-					tickSize = speed >= duration_cast<nanoseconds>(1ms) ? 1 : duration_cast<nanoseconds>(1ms) / speed;
-
-					// max sensible tick size is 1 minute, unless there is combat.
-//						if (tickSize > 60) {
-//							tickSize = 60
-//						}
+					
+					tickSize = adjustTickSize(lastTickDuration);
 					
 					const nanoseconds tickSpeed = speed * tickSize;
 					
@@ -85,8 +162,11 @@ void Galaxy::galaxyWorker() {
 					LOG4CXX_TRACE(log, "tick " << time);
 					updateDay();
 					
+					// A working shadow the UI did not get last tick keeps its events and changes, they are handed over together with this ticks
 					ProfilerEvents& profilerEvents = workingShadow->profilerEvents;
-					profilerEvents.clear();
+					if (missedShadowSwaps == 0) {
+						profilerEvents.clear();
+					}
 					
 					const nanoseconds systemUpdateStart = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch());
 					
@@ -106,17 +186,18 @@ void Galaxy::galaxyWorker() {
 					}
 					profilerEvents.end();
 					
-					completedWorkCounter = 0;
-					takenWorkCounter = 0;
-					
 					profilerEvents.start("run threads");
-					{
-						std::unique_lock<LockableBase(std::mutex)> lock(workerMutex);
-						workerCondvar.notify_all();
+					const nanoseconds runStart = getNanos();
+					tickBarrier.start(systems.size()); // Before pushing so that a job can never be finished before it is counted
+					for (uint32_t i = 0; i < systems.size(); i++) {
+						jobs.push(systems[i]->homeWorker, Job { &Galaxy::updateSystem, this, i, nullptr, Aurora.settings.galaxy.pinWorkers });
+					}
+					
+					if (missedShadowSwaps == 0) {
+						workingShadow->added.clear();
+						workingShadow->changed.clear();
+						workingShadow->deleted.clear();
 					}
-					workingShadow->added.clear();
-					workingShadow->changed.clear();
-					workingShadow->deleted.clear();
 					
 					profilerEvents.start("process");
 					scheduler.update(tickSize);
@@ -126,37 +207,53 @@ void Galaxy::galaxyWorker() {
 					workingShadow->update();
 					profilerEvents.end();
 					
-//					setThreadPriority(*galaxyThread, ThreadPriority::LOW);
-					while (completedWorkCounter.load(std::memory_order_relaxed) < systems.size() && !shutdown) {
-//						std::this_thread::yield();
-						std::unique_lock<std::mutex> lock(galaxyThreadMutex);
-//						galaxyThreadCondvar.wait(lock);
-						galaxyThreadCondvar.wait_for(lock, 1000ms);
+					// Help out with left over jobs instead of sleeping while workers are busy, pinned systems are left to their home worker
+					while (!tickBarrier.isDone() && jobs.runOne()) {}
+					
+					// Systems usually take about as long as last tick, spin through that if it is short instead of parking
+					if (!tickBarrier.waitDone(lastRunDuration - (getNanos() - runStart))) {
+						LOG4CXX_ERROR(log, "Tick " << time << " aborted, a starsystem worker stopped");
+						break;
 					}
+					lastRunDuration = getNanos() - runStart;
 					profilerEvents.end();
-//					setThreadPriority(*galaxyThread, ThreadPriority::NORMAL);
 					
+					tickBarrier.collectLatencies();
+					profilerEvents.metric("wake latency p50", tickBarrier.latencyPercentile(50));
+					profilerEvents.metric("wake latency p90", tickBarrier.latencyPercentile(90));
+					profilerEvents.metric("wake latency p99", tickBarrier.latencyPercentile(99));
+					
+					// Star system shadows are picked up by the UI on its own through ShadowHandle, only the galaxy shadow is still swapped under a lock
 					profilerEvents.start("shadows lock");
 					{
-						std::unique_lock<LockableBase(std::mutex)> lock(shadowLock);
-						profilerEvents.start("promote shadows");
-						for (StarSystem* system : systems) {
-							auto oldShadowWorld = system->shadow;
-							
-							system->shadow = system->workingShadow;
-							system->workingShadow = oldShadowWorld;
+						// With non blocking promotion the UI keeps the previous galaxy shadow a bit longer instead of stalling the next tick,
+						//  but only for so many ticks so that the carried over events do not pile up
+						std::unique_lock<LockableBase(std::mutex)> lock(shadowLock, std::defer_lock);
+						if (Aurora.settings.galaxy.nonBlockingPromotion && missedShadowSwaps < MAX_MISSED_SHADOW_SWAPS) {
+							lock.try_lock();
+						} else {
+							lock.lock();
 						}
 						
-						auto oldShadowWorld = shadow;
-						
-						shadow = workingShadow;
-						workingShadow = oldShadowWorld;
-						profilerEvents.end();
+						if (lock.owns_lock()) {
+							auto oldShadowWorld = shadow;
+							
+							shadow = workingShadow;
+							workingShadow = oldShadowWorld;
+							missedShadowSwaps = 0;
+							
+						} else {
+							missedShadowSwaps++;
+						}
 					}
 					profilerEvents.end();
 					
 					nanoseconds systemUpdateDuration = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()) - systemUpdateStart;
 					speedLimited = systemUpdateDuration > speed;
+					lastTickDuration = systemUpdateDuration;
+					
+					// Workers spin until the next tick if it is expected soon, otherwise park right away
+					tickBarrier.setSpinBudget(speedLimited ? TickBarrier::MAX_SPIN : tickSpeed - systemUpdateDuration);
 					
 					if (speedLimited) {
 //							log.warn("Galaxy update took ${Units.nanoToString(systemUpdateDuration)} which is more than the requested speed delay ${Units.nanoToString(speed)}")
@@ -168,20 +265,37 @@ void Galaxy::galaxyWorker() {
 //						}
 //						println()
 					
-					// If one system took a noticeable larger time to process than others, schedule it earlier
-					profilerEvents.start("system sort");
-					std::sort(systems.begin(), systems.end(), [s = tickSpeed / 10](const StarSystem* a, const StarSystem* b) -> bool {
-						nanoseconds diff = a->updateTime - b->updateTime;
-						if (abs(a->updateTime - b->updateTime) <= s) {
-							return false;
-						}
+					if (Aurora.settings.galaxy.pinWorkers) {
+						profilerEvents.start("system rebalance");
+						rebalanceSystems();
+						profilerEvents.end();
 						
-						return a->updateTime < b->updateTime;
-					});
-					profilerEvents.end();
+					} else {
+						// If one system took a noticeable larger time to process than others, schedule it earlier
+						profilerEvents.start("system sort");
+						std::sort(systems.begin(), systems.end(), [s = tickSpeed / 10](const StarSystem* a, const StarSystem* b) -> bool {
+							nanoseconds diff = a->updateTime - b->updateTime;
+							if (abs(a->updateTime - b->updateTime) <= s) {
+								return false;
+							}
+							
+							return a->updateTime < b->updateTime;
+						});
+						
+						for (uint32_t i = 0; i < systems.size(); i++) {
+							systems[i]->homeWorker = i % jobs.workers();
+						}
+						profilerEvents.end();
+					}
 					
 					lastProcess = now;
 				}
+				
+				if (now - lastSpeedSample >= 1s) {
+					achievedSpeed.store((time - lastSpeedSampleTime) / duration<double>(now - lastSpeedSample).count(), std::memory_order_relaxed);
+					lastSpeedSample = now;
+					lastSpeedSampleTime = time;
+				}
 
 				lastSleep = now;
 				
@@ -204,74 +318,188 @@ void Galaxy::galaxyWorker() {
 
 			} else {
 				oldSpeed = speed;
+				
+				// Paused, start sampling over once we are running again
+				achievedSpeed.store(0, std::memory_order_relaxed);
+				lastSpeedSample = now;
+				lastSpeedSampleTime = time;
+				
 				std::unique_lock<std::mutex> lock(galaxyThreadMutex);
 				galaxyThreadCondvar.wait_for(lock, 1s);
 			}
 		}
 		
-		{
-			std::unique_lock<LockableBase(std::mutex)> lock(workerMutex);
-			workerCondvar.notify_all();
-		}
-		
-		for (std::thread* thread : threads) {
-			thread->join();
-			delete thread;
-		}
-		
 	} catch (const std::exception &e) {
 		std::string stackTrace = getLastExceptionStacktrace();
 		LOG4CXX_ERROR(log, "Exception in galaxy loop" << e.what() << "\n" << stackTrace);
 		speed = 0s;
 	}
+	
+	tickBarrier.stop();
+	jobs.wakeAll();
+	
+	for (std::thread* thread : threads) {
+		thread->join();
+		delete thread;
+	}
+	threads.clear();
 }
 
-void Galaxy::starsystemWorker() {
-	static std::atomic<uint32_t> workerIDs;
-	tracy::SetThreadName(fmt::format("starsystem-worker-{}", workerIDs++).c_str());
-	
-	while (!shutdown) {
-		{
-			std::unique_lock<LockableBase(std::mutex)> lock(workerMutex);
-			if (takenWorkCounter >= systems.size()) {
-				workerCondvar.wait(lock);
-			}
+uint32_t Galaxy::adjustTickSize(nanoseconds tickDuration) {
+	// Ticking more than 1000 times per wall second only wastes cycles on overhead
+	const uint32_t minTickSize = speed >= duration_cast<nanoseconds>(1ms) ? 1 : duration_cast<nanoseconds>(1ms) / speed;
+	uint32_t maxTickSize = MAX_TICK_SIZE;
+	
+	// Long ticks would let shots and missiles skip past their targets
+	for (StarSystem* system : systems) {
+		if (system->inCombat()) {
+			maxTickSize = COMBAT_TICK_SIZE;
+			break;
+		}
+	}
+	
+	uint32_t newTickSize = minTickSize;
+	
+	if (tickDuration > 0ns) {
+		// The slowest system decides how long a tick takes, its average smooths out single slow ticks
+		nanoseconds slowestSystem = 0ns;
+		for (StarSystem* system : systems) {
+			slowestSystem = std::max(slowestSystem, nanoseconds((int64_t) system->updateTimeAverage));
 		}
+		
+		// Fraction of the wall time the last tick covered that was spent processing it
+		float utilization = std::max(tickDuration, slowestSystem).count() / (float) (speed * tickSize).count();
+		newTickSize = tickSize;
+		
+		if (utilization > 0.9f) { // Falling behind, grow so that a tick takes about half of the wall time it covers
+			newTickSize = std::min(std::ceil(tickSize * utilization / 0.5f), (float) MAX_TICK_SIZE);
+			
+		} else if (utilization < 0.25f) { // Plenty of headroom, go back towards finer ticks
+			newTickSize = tickSize / 2;
+		}
+	}
+	
+	return std::clamp(newTickSize, std::min(minTickSize, maxTickSize), maxTickSize);
+}
 
-		if (shutdown) {
-			return;
+void Galaxy::starsystemWorker(uint32_t workerIndex) {
+	tracy::SetThreadName(fmt::format("starsystem-worker-{}", workerIndex).c_str());
+	JobSystem::setWorker(workerIndex);
+	
+	uint32_t epoch = 0;
+	
+	try {
+		while (!shutdown && !tickBarrier.isStopped()) {
+			epoch = tickBarrier.waitStart(workerIndex, epoch);
+			
+			if (shutdown || tickBarrier.isStopped()) {
+				return;
+			}
+			
+			// Run our own systems first, then steal systems and sub jobs from other workers until the tick is done.
+			//  When there is nothing left to take park until something is pushed, which may be the next tick.
+			while (true) {
+				// Before checking for the end, otherwise the wakeAll on shutdown can be missed and we park forever
+				uint32_t generation = jobs.getGeneration();
+				
+				if (!tickBarrier.hasWork() || shutdown) {
+					break;
+				}
+				
+				if (!jobs.runOne()) {
+					jobs.waitForJobs(generation);
+				}
+			}
 		}
+		
+	} catch (...) {
+		// updateSystem handles exceptions from systems, this is something worse. The job we were running will never finish its tick.
+		std::string stackTrace = getLastExceptionStacktrace();
+		LOG4CXX_ERROR(log, "Exception in starsystem worker " << workerIndex << "\n" << stackTrace);
+		speed = 0s;
+		tickBarrier.stop();
+		jobs.wakeAll();
+	}
+}
 
-		uint32_t systemIndex = takenWorkCounter++;
+void Galaxy::simulateSystem(void* data, uint32_t systemIndex) {
+	Galaxy& galaxy = *static_cast<Galaxy*>(data);
+	galaxy.systems[systemIndex]->update(galaxy.tickSize);
+}
 
-//		println("index ${Thread.currentThread().name} = $systemIndex")
+void Galaxy::updateSystem(void* data, uint32_t systemIndex) {
+	Galaxy& galaxy = *static_cast<Galaxy*>(data);
+	StarSystem& system = *galaxy.systems[systemIndex];
 
-		while (systemIndex < systems.size()) {
+	uint32_t worker = JobSystem::getWorker();
+	if (system.lastWorker != worker) {
+		if (system.lastWorker != JobSystem::NO_WORKER) {
+			galaxy.systemMigrations.fetch_add(1, std::memory_order_relaxed);
+		}
+		system.lastWorker = worker;
+	}
 
-			StarSystem& system = *systems[systemIndex];
+	try {
+		nanoseconds systemUpdateStart = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch());
+		system.update(galaxy.tickSize);
+		system.updateTime = (duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()) - systemUpdateStart);
 
-			try {
-				nanoseconds systemUpdateStart = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch());
-				system.update(tickSize);
-				system.updateTime = (duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()) - systemUpdateStart);
+		system.updateTimeAverage = exponentialAverage(system.updateTime.count(), system.updateTimeAverage, std::min(100.0, (double)(Units::NANO_SECOND / std::abs(galaxy.speed.count()))));
 
-				system.updateTimeAverage = exponentialAverage(system.updateTime.count(), system.updateTimeAverage, std::min(100.0, (double)(Units::NANO_SECOND / std::abs(speed.count()))));
+	} catch (const std::exception& e) {
+		std::string stackTrace = getLastExceptionStacktrace();
+		LOG4CXX_ERROR(galaxy.log, "Exception in system update for " << system << " tick " << galaxy.time << " " << e.what() << "\n" << stackTrace);
+		galaxy.speed = 0s;
+	}
 
-			} catch (const std::exception& e) {
-				std::string stackTrace = getLastExceptionStacktrace();
-				LOG4CXX_ERROR(log, "Exception in system update for $system tick ${galaxy.time}" << e.what() << "\n" << stackTrace);
-				speed = 0s;
-			}
+	galaxy.tickBarrier.finishOne();
+}
 
-			if (++completedWorkCounter == systems.size()) {
-				std::unique_lock<std::mutex> lock(galaxyThreadMutex);
-				galaxyThreadCondvar.notify_one();
-				break;
+// Moves at most one system per tick from the slowest to the fastest worker, and only if the slowest worker
+//  is rebalanceSkew times slower than the average so that systems normally stay on the same core.
+void Galaxy::rebalanceSystems() {
+	uint32_t workers = jobs.workers();
+	
+	if (workers < 2 || systems.size() < 2) {
+		return;
+	}
+	
+	std::vector<float> workerLoad(workers);
+	float totalLoad = 0;
+	
+	for (StarSystem* system : systems) {
+		workerLoad[system->homeWorker] += system->updateTimeAverage;
+		totalLoad += system->updateTimeAverage;
+	}
+	
+	uint32_t slowest = std::max_element(workerLoad.begin(), workerLoad.end()) - workerLoad.begin();
+	uint32_t fastest = std::min_element(workerLoad.begin(), workerLoad.end()) - workerLoad.begin();
+	float averageLoad = totalLoad / workers;
+	
+	if (averageLoad <= 0 || workerLoad[slowest] < averageLoad * Aurora.settings.galaxy.rebalanceSkew) {
+		return;
+	}
+	
+	// Pick the system that brings the two workers closest to each other without just swapping which one is the slowest
+	float gap = workerLoad[slowest] - workerLoad[fastest];
+	StarSystem* best = nullptr;
+	float bestRemainingGap = gap;
+	
+	for (StarSystem* system : systems) {
+		if (system->homeWorker == slowest) {
+			float remainingGap = std::abs(gap - 2 * system->updateTimeAverage);
+			
+			if (remainingGap < bestRemainingGap) {
+				bestRemainingGap = remainingGap;
+				best = system;
 			}
-
-			systemIndex = takenWorkCounter++;
 		}
 	}
+	
+	if (best != nullptr) {
+		LOG4CXX_DEBUG(log, "Moving system " << *best << " from worker " << slowest << " to " << fastest);
+		best->homeWorker = fastest;
+	}
 }
 
 void Galaxy::updateSpeed() {
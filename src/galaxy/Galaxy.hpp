@@ -22,7 +22,9 @@
 #include "galaxy/Empire.hpp"
 #include "galaxy/Player.hpp"
 #include "starsystems/systems/Scheduler.hpp"
+#include "utils/JobSystem.hpp"
 #include "utils/Profiling.hpp"
+#include "utils/TickBarrier.hpp"
 
 using namespace std::chrono;
 using namespace log4cxx;
@@ -59,7 +61,7 @@ class Galaxy {
 		std::mutex galaxyThreadMutex;
 		std::condition_variable galaxyThreadCondvar;
 		ShadowGalaxy* shadow = new ShadowGalaxy(this);
-		TracyLockable(std::mutex, shadowLock);
+		TracyLockable(std::mutex, shadowLock); // Guards swapping shadow, star system shadows are read through StarSystem::acquireShadow
 		ProfilerEvents renderProfilerEvents;
 		
 		uint64_t time = 0; // seconds
@@ -67,10 +69,17 @@ class Galaxy {
 		nanoseconds speed = 1s;
 		bool speedLimited = false;
 		uint32_t tickSize = 1;
+		std::atomic<double> achievedSpeed = 0; // Game seconds per wall second, sampled once per second and 0 while paused
+		
+		static constexpr uint32_t MAX_TICK_SIZE = 3600;
+		static constexpr uint32_t COMBAT_TICK_SIZE = 60;
 		
 		std::vector<Empire> empires;
 		std::vector<Player> players;
 		
+		JobSystem jobs;
+		std::atomic<uint64_t> systemMigrations = 0; // Times a system was updated on a different worker than the previous tick
+		
 		Galaxy(std::vector<Empire>& empires, std::vector<StarSystem*>& systems, std::vector<Player> players) {
 			Galaxy::empires = std::move(empires);
 			Galaxy::systems = std::move(systems);
@@ -78,24 +87,35 @@ class Galaxy {
 		}
 		Galaxy(const Galaxy&) = default;
 		Galaxy(Galaxy&&) = default;
+		// Owns its star systems. Only for galaxies whose threads have been joined, or that were only simulated headless.
+		~Galaxy();
 		
 		void init();
 		void updateSpeed();
+		
+		// For checking determinism and benchmarking. Initializes the star systems without starting the galaxy thread,
+		//  then simulate runs ticks ticks on workerCount temporary workers and returns the combined hash of all systems.
+		void initHeadless();
+		// Once per galaxy, the job queues are created for workerCount workers
+		uint64_t simulate(uint32_t ticks, uint32_t workerCount = std::max(std::thread::hardware_concurrency(), 1U));
 
 	private:
 		LoggerPtr log = Logger::getLogger("aurora.galaxy");
 		std::vector<std::thread*> threads;
-		TracyLockable(std::mutex, workerMutex);
-		std::condition_variable_any workerCondvar;
-		std::atomic<uint32_t> takenWorkCounter;
-		std::atomic<uint32_t> completedWorkCounter;
+		TickBarrier tickBarrier;
 		ShadowGalaxy* workingShadow = new ShadowGalaxy(this);
+		uint32_t missedShadowSwaps = 0; // Ticks in a row the UI held shadowLock when workingShadow was to be swapped in
+		static constexpr uint32_t MAX_MISSED_SHADOW_SWAPS = 10;
 		
 		entt::registry registry;
 		Scheduler<std::uint32_t> scheduler;
 
 		void galaxyWorker();
-		void starsystemWorker();
+		void starsystemWorker(uint32_t workerIndex);
+		static void updateSystem(void* galaxy, uint32_t systemIndex);
+		static void simulateSystem(void* galaxy, uint32_t systemIndex);
+		void rebalanceSystems();
+		uint32_t adjustTickSize(nanoseconds tickDuration);
 		int updateDay();
 };
 
@@ -9,8 +9,12 @@
 #include <fmt/format.h>
 #include <starsystems/ShadowStarSystem.hpp>
 
+#include "Tracy.hpp"
+
+#include "Aurora.hpp"
 #include "starsystems/components/Components.hpp"
 #include "starsystems/StarSystem.hpp"
+#include "galaxy/Galaxy.hpp"
 
 #undef PROFILE
 #undef PROFILE_End
@@ -33,91 +37,201 @@ static entt::entity getEntity(uint32_t entityID) { // No version number
 	return static_cast<entt::entity>(entityID);;
 };
 
+// Brings mirror up to date with the simulation tree by replaying the edits it missed, or copies the whole tree when there
+//  are more edits than elements. Takes the journal of this tick from tree into ops for addPending.
+template<typename Tree, typename Op>
+static void syncQuadtree(Tree& mirror, Tree& tree, std::vector<Op>& ops, std::vector<Op>& pendingOps, bool& pendingCopy) {
+	ops.clear();
+	ops.swap(tree.journal);
+	
+	if (pendingCopy || pendingOps.size() + ops.size() > static_cast<size_t>(tree.elts.range())) {
+		mirror = tree;
+		mirror.journaling = false;
+		
+	} else {
+		mirror.replay(pendingOps);
+		mirror.replay(ops);
+		assert(mirror.nodes.size() == tree.nodes.size() && mirror.elts.range() == tree.elts.range());
+	}
+	
+	pendingOps.clear();
+	pendingCopy = false;
+}
+
+template<typename Tree, typename Op>
+static void addPendingOps(Tree& tree, std::vector<Op>& ops, std::vector<Op>& pendingOps, bool& pendingCopy) {
+	if (pendingCopy) {
+		return;
+	}
+	
+	if (pendingOps.size() + ops.size() > static_cast<size_t>(tree.elts.range())) {
+		pendingOps.clear();
+		pendingCopy = true;
+		
+	} else {
+		pendingOps.insert(pendingOps.end(), ops.begin(), ops.end());
+	}
+}
+
+#define UPDATE_TEMPLATE(r, unused, component) \
+PROFILE(BOOST_PP_STRINGIZE(component)); \
+updateComponent<component>(tmpComponents[syncedComponentToIndexMap[hana::type_c<component>]]); \
+PROFILE_End();
+
+#define ASSURE_TEMPLATE(r, unused, component) \
+(void) registry.view<component>(); \
+(void) realRegistry.view<component>();
+
+// Replays the changes of this tick and all ticks since this shadow was last the working shadow.
+// Added and deleted only mark entities that had a synced component constructed or destroyed so the real registry decides
+//  if the entity was created, destroyed or just had components added or removed.
 void ShadowStarSystem::update() {
-	ShadowStarSystem* otherShadow = starSystem.shadow;
+	entt::registry& realRegistry = starSystem.registry;
 	
 	{
-		uint32_t size = std::max({added.size(), changed.size(), deleted.size(), otherShadow->added.size(), otherShadow->changed.size(), otherShadow->deleted.size()});
-		tmp.reserve(size);
+		uint32_t size = std::max({added.size(), changed.size(), deleted.size(), pendingAdded.size(), pendingChanged.size(), pendingDeleted.size()});
+		tmpAdded.reserve(size);
+		tmpDeleted.reserve(size);
 		added.reserve(size);
 		changed.reserve(size);
 		deleted.reserve(size);
+		pendingAdded.reserve(size);
+		pendingChanged.reserve(size);
+		pendingDeleted.reserve(size);
 		
 		for (uint_fast8_t i=0; i < SYNCED_COMPONENTS_SEQ_SIZE; i++) {
 			tmpComponents[i].reserve(size);
+			changedComponents[i].reserve(size);
+			pendingComponents[i].reserve(size);
 		}
 	}
 	
 	auto strBuf = fmt::memory_buffer();
 	
-	// Skip added and deleted in same tick
-	tmp = added;
-	tmp &= deleted;
-	added %= tmp;
-	changed %= tmp;
-	deleted %= tmp;
+	tmpDeleted = deleted;
+	tmpDeleted |= pendingDeleted;
 	
-	changed %= added; // Skip created and modified in same tick
+	tmpAdded = added;
+	tmpAdded |= pendingAdded;
 	
 	PROFILE("deleted");
-	tmp = deleted;
-	tmp |= otherShadow->deleted;
-	for (auto entityID : tmp) {
+	for (auto entityID : tmpDeleted) {
 		entt::entity entity = getCurrentEntity(registry, entityID);
-		registry.destroy(entity);
+		
+		if (registry.valid(entity) && !realRegistry.valid(getCurrentEntity(realRegistry, entityID))) {
+			registry.destroy(entity);
+		} else {
+			tmpAdded[entityID] = true; // Only had components removed, or was destroyed and recreated
+		}
 	}
 	PROFILE_End();
 	
-	tmp = changed;
-	tmp |= otherShadow->changed;
-	tmp %= otherShadow->added; // Skip other added as they will be handled as added below
-	tmp %= deleted; // Skip now deleted from other changed
-	tmp %= otherShadow->deleted; // Skip other deleted from other changed
+	PROFILE("added");
+	for (auto entityID : tmpAdded) {
+		if (!realRegistry.valid(getCurrentEntity(realRegistry, entityID))) {
+			continue;
+		}
+		
+		PROFILE2("{}", entityID);
+		entt::entity entity = getCurrentEntity(registry, entityID);
+		
+		if (registry.valid(entity)) {
+			syncComponents(entityID, entity);
+			
+		} else {
+			entity = registry.create(getEntity(entityID));
+			assert(entityID == static_cast<uint32_t>(registry.entity(entity)));
+			addComponents(entityID, entity);
+		}
+		PROFILE_End();
+	}
+	PROFILE_End();
 	
 	for (uint_fast8_t i=0; i < SYNCED_COMPONENTS_SEQ_SIZE; i++) {
 		tmpComponents[i] = changedComponents[i];
-		tmpComponents[i] |= otherShadow->changedComponents[i];
+		tmpComponents[i] |= pendingComponents[i];
+		tmpComponents[i] %= tmpAdded; // Already fully synced above
 	}
 	
 	PROFILE("changed");
-	for (auto entityID : tmp) {
-		PROFILE2("{}", entityID);
-		entt::entity entity = getCurrentEntity(registry, entityID);
-		updateComponents(entityID, entity);
-		PROFILE_End();
+	if (realRegistry.alive() >= Aurora.settings.galaxy.parallelShadowSync) {
+		// Components live in separate pools so they can be copied concurrently once all entities exist, as long as no pool is created meanwhile
+		BOOST_PP_SEQ_FOR_EACH(ASSURE_TEMPLATE, ~, SYNCED_COMPONENTS_SEQ);
+		
+		starSystem.galaxy->jobs.parallelFor(&ShadowStarSystem::updateComponentJob, this, SYNCED_COMPONENTS_SEQ_SIZE);
+		
+	} else {
+		BOOST_PP_SEQ_FOR_EACH(UPDATE_TEMPLATE, ~, SYNCED_COMPONENTS_SEQ);
 	}
 	PROFILE_End();
 	
-	tmp = added;
-	tmp |= otherShadow->added;
-	tmp %= deleted; // Skip other added that are now deleted
+	PROFILE("sync quadtree ships");
+	syncQuadtree(quadtreeShips, starSystem.systems->spatialPartitioningSystem->tree, quadtreeShipsOps, pendingQuadtreeShipsOps, pendingQuadtreeShipsCopy);
+	PROFILE_End();
 	
-	PROFILE("added");
-	for (auto entityID : tmp) {
-		PROFILE2("{}", entityID);
-		entt::entity entity = registry.create(getEntity(entityID));
-		assert(entityID == static_cast<uint32_t>(registry.entity(entity)));
-		addComponents(entityID, entity);
-		PROFILE_End();
+	PROFILE("sync quadtree planetoids");
+	syncQuadtree(quadtreePlanetoids, starSystem.systems->spatialPartitioningPlanetoidsSystem->tree, quadtreePlanetoidsOps, pendingQuadtreePlanetoidsOps, pendingQuadtreePlanetoidsCopy);
+	PROFILE_End();
+	
+	PROFILE("sync uuids map");
+	if (pendingUuidsCopy) {
+		uuids = starSystem.uuids;
+		
+	} else {
+		replayUuids(pendingUuidsOps);
+		replayUuids(uuidsOps);
+		assert(uuids.size() == starSystem.uuids.size());
 	}
 	PROFILE_End();
 	
-	if (quadtreeShipsChanged || starSystem.shadow->quadtreeShipsChanged) {
-		PROFILE("copy quadtree ships");
-		quadtreeShips = starSystem.systems->spatialPartitioningSystem->tree;
-		PROFILE_End();
+	pendingAdded.clear();
+	pendingChanged.clear();
+	pendingDeleted.clear();
+	
+	for (HierarchicalBitVector& bitVector : pendingComponents) {
+		bitVector.clear();
 	}
 	
-	if (quadtreePlanetoidsChanged || starSystem.shadow->quadtreePlanetoidsChanged) {
-		PROFILE("copy quadtree planetoids");
-		quadtreePlanetoids = starSystem.systems->spatialPartitioningPlanetoidsSystem->tree;
-		PROFILE_End();
+	pendingUuidsOps.clear();
+	pendingUuidsCopy = false;
+}
+
+void ShadowStarSystem::addPending(ShadowStarSystem& source) {
+	uint32_t size = std::max({source.added.size(), source.changed.size(), source.deleted.size()});
+	pendingAdded.reserve(size);
+	pendingChanged.reserve(size);
+	pendingDeleted.reserve(size);
+	
+	pendingAdded |= source.added;
+	pendingChanged |= source.changed;
+	pendingDeleted |= source.deleted;
+	
+	for (uint_fast8_t i=0; i < SYNCED_COMPONENTS_SEQ_SIZE; i++) {
+		pendingComponents[i].reserve(source.changedComponents[i].size());
+		pendingComponents[i] |= source.changedComponents[i];
 	}
 	
-	if (uuidsChanged || starSystem.shadow->uuidsChanged) {
-		PROFILE("copy uuids map");
-		uuids = starSystem.uuids;
-		PROFILE_End();
+	if (!pendingUuidsCopy) {
+		if (pendingUuidsOps.size() + source.uuidsOps.size() > starSystem.uuids.size()) {
+			pendingUuidsOps.clear();
+			pendingUuidsCopy = true;
+			
+		} else {
+			pendingUuidsOps.insert(pendingUuidsOps.end(), source.uuidsOps.begin(), source.uuidsOps.end());
+		}
+	}
+	
+	addPendingOps(starSystem.systems->spatialPartitioningSystem->tree, source.quadtreeShipsOps, pendingQuadtreeShipsOps, pendingQuadtreeShipsCopy);
+	addPendingOps(starSystem.systems->spatialPartitioningPlanetoidsSystem->tree, source.quadtreePlanetoidsOps, pendingQuadtreePlanetoidsOps, pendingQuadtreePlanetoidsCopy);
+}
+
+void ShadowStarSystem::replayUuids(const std::vector<UUIDOp>& ops) {
+	for (const UUIDOp& op : ops) {
+		if (op.entity == entt::null) {
+			uuids.erase(op.uuid);
+		} else {
+			uuids[op.uuid] = op.entity;
+		}
 	}
 }
 
@@ -149,35 +263,134 @@ void ShadowStarSystem::addComponents(uint32_t entityID, entt::entity shadowEntit
 	BOOST_PP_SEQ_FOR_EACH(ADD_TEMPLATE, ~, SYNCED_COMPONENTS_SEQ);
 }
 
-#define UPDATE_TEMPLATE(r, unused, component) \
-if (tmpComponents[syncedComponentToIndexMap[hana::type_c<component>]][entityID]) { \
+#define SYNC_TEMPLATE(r, unused, component) \
+{ \
 	component* realComp = starSystem.registry.try_get<component>(realEntity); \
 	if (realComp) { \
-		component* shadowComp; \
-		if (registry.all_of<component>(shadowEntity)) { \
-			shadowComp = &registry.get<component>(shadowEntity); \
-		} else { \
-			shadowComp = &registry.emplace<component>(shadowEntity); \
-		} \
-		*shadowComp = *realComp; \
+		registry.emplace_or_replace<component>(shadowEntity, *realComp); \
 	} else { \
 		registry.remove_if_exists<component>(shadowEntity); \
 	} \
 }
 
-void ShadowStarSystem::updateComponents(uint32_t entityID, entt::entity shadowEntity) {
+void ShadowStarSystem::syncComponents(uint32_t entityID, entt::entity shadowEntity) {
 	entt::entity realEntity = getCurrentEntity(starSystem.registry, entityID);
-	TimedMovementComponent* realComp = starSystem.registry.try_get<TimedMovementComponent>(realEntity);
-	if (realComp) {
-		TimedMovementComponent* shadowComp;
-		if (registry.all_of<TimedMovementComponent>(shadowEntity)) {
-			shadowComp = &registry.get<TimedMovementComponent>(shadowEntity);
-		} else {
-			shadowComp = &registry.emplace<TimedMovementComponent>(shadowEntity);
+	BOOST_PP_SEQ_FOR_EACH(SYNC_TEMPLATE, ~, SYNCED_COMPONENTS_SEQ);
+}
+
+// Copies one component of the given entities, looking up both pools once instead of through the registry for each entity
+template<typename Component>
+void ShadowStarSystem::updateComponent(HierarchicalBitVector& entityIDs) {
+	entt::registry& realRegistry = starSystem.registry;
+	auto realPool = realRegistry.view<Component>();
+	auto shadowPool = registry.view<Component>();
+	
+	if (realPool.size() > 0 && entityIDs.cardinality() >= realPool.size() * Aurora.settings.galaxy.packedShadowSync) {
+		copyPool<Component>();
+		return;
+	}
+	
+	for (auto entityID : entityIDs) {
+		entt::entity shadowEntity = getCurrentEntity(registry, entityID);
+		
+		if (!registry.valid(shadowEntity)) {
+			continue;
+		}
+		
+		entt::entity realEntity = getCurrentEntity(realRegistry, entityID);
+		
+		if (realPool.contains(realEntity)) {
+			const Component& realComp = realPool.template get<Component>(realEntity);
+			
+			if (shadowPool.contains(shadowEntity)) {
+				Component& shadowComp = shadowPool.template get<Component>(shadowEntity);
+				
+				if constexpr (std::is_trivially_copyable_v<Component>) {
+					std::memcpy(&shadowComp, &realComp, sizeof(Component));
+				} else {
+					shadowComp = realComp;
+				}
+				
+			} else {
+				registry.emplace<Component>(shadowEntity, realComp);
+			}
+			
+		} else if (shadowPool.contains(shadowEntity)) {
+			registry.remove<Component>(shadowEntity);
+		}
+	}
+}
+
+// Copies the packed component array of the real pool over the shadow one. The shadow pool is first given the same
+//  entities and then sorted into the same order, which after the first copy normally is already the case.
+template<typename Component>
+void ShadowStarSystem::copyPool() {
+	entt::registry& realRegistry = starSystem.registry;
+	auto realPool = realRegistry.view<Component>();
+	auto shadowPool = registry.view<Component>();
+	
+	std::vector<entt::entity> removed;
+	
+	for (entt::entity shadowEntity : shadowPool) {
+		if (!realPool.contains(getCurrentEntity(realRegistry, static_cast<uint32_t>(registry.entity(shadowEntity))))) {
+			removed.push_back(shadowEntity);
+		}
+	}
+	
+	registry.remove<Component>(removed.begin(), removed.end());
+	
+	for (entt::entity realEntity : realPool) {
+		entt::entity shadowEntity = getCurrentEntity(registry, static_cast<uint32_t>(realRegistry.entity(realEntity)));
+		assert(registry.valid(shadowEntity));
+		
+		if (!shadowPool.contains(shadowEntity)) {
+			registry.emplace<Component>(shadowEntity, realPool.template get<Component>(realEntity));
+		}
+	}
+	
+	size_t size = realPool.size();
+	assert(shadowPool.size() == size);
+	
+	auto sameOrder = [&]() {
+		return std::equal(realPool.data(), realPool.data() + size, shadowPool.data(), [&](entt::entity real, entt::entity shadow) {
+			return realRegistry.entity(real) == registry.entity(shadow);
+		});
+	};
+	
+	if (!sameOrder()) {
+		std::vector<uint32_t> packedIndex(realRegistry.size());
+		
+		for (size_t i = 0; i < size; i++) {
+			packedIndex[static_cast<uint32_t>(realRegistry.entity(realPool.data()[i]))] = i;
 		}
-		*shadowComp = *realComp;
+		
+		// Sorting orders the pool as views iterate it, which is from the back of the packed array
+		registry.sort<Component>([&](const entt::entity lhs, const entt::entity rhs) {
+			return packedIndex[static_cast<uint32_t>(registry.entity(lhs))] > packedIndex[static_cast<uint32_t>(registry.entity(rhs))];
+		});
+		
+		assert(sameOrder());
+	}
+	
+	if constexpr (std::is_trivially_copyable_v<Component>) {
+		std::memcpy(shadowPool.raw(), realPool.raw(), size * sizeof(Component));
 	} else {
-		registry.remove_if_exists<TimedMovementComponent>(shadowEntity);
-	} 
-	BOOST_PP_SEQ_FOR_EACH(UPDATE_TEMPLATE, ~, SYNCED_COMPONENTS_SEQ);
+		std::copy(realPool.raw(), realPool.raw() + size, shadowPool.raw());
+	}
+}
+
+#define UPDATE_JOB_TEMPLATE(r, unused, index, component) \
+case index: { \
+	ZoneScopedN(BOOST_PP_STRINGIZE(component)); \
+	shadow.updateComponent<component>(shadow.tmpComponents[index]); \
+	break; \
+}
+
+// One synced component per job, profilerEvents is not thread safe so only Tracy sees these
+void ShadowStarSystem::updateComponentJob(void* data, uint32_t componentIndex) {
+	ShadowStarSystem& shadow = *static_cast<ShadowStarSystem*>(data);
+	
+	switch (componentIndex) {
+		BOOST_PP_SEQ_FOR_EACH_I(UPDATE_JOB_TEMPLATE, ~, SYNCED_COMPONENTS_SEQ)
+	}
 }
@@ -38,6 +38,12 @@ constexpr auto syncedComponentToIndexMap = hana::make_map(
 		BOOST_PP_ENUM(SYNCED_COMPONENTS_SEQ_SIZE, SYNCED_COMPONENTS_MAP_MACRO, ~)
 );
 
+// Change to a uuids map, erases the uuid when entity is null
+struct UUIDOp {
+	EntityUUID uuid;
+	entt::entity entity;
+};
+
 class ShadowStarSystem {
 	public:
 		ShadowStarSystem(StarSystem& starSystem): starSystem(starSystem) {}
@@ -46,14 +52,14 @@ class ShadowStarSystem {
 		entt::registry registry;
 		std::unordered_map<EntityUUID, entt::entity, EntityUUID::hasher> uuids;
 		
-		BitVector added;
-		BitVector changed;
-		BitVector changedComponents[SYNCED_COMPONENTS_SEQ_SIZE];
-		BitVector deleted;
+		HierarchicalBitVector added;
+		HierarchicalBitVector changed;
+		HierarchicalBitVector changedComponents[SYNCED_COMPONENTS_SEQ_SIZE];
+		HierarchicalBitVector deleted;
 
-		bool uuidsChanged = false;
-		bool quadtreeShipsChanged = false;
-		bool quadtreePlanetoidsChanged = false;
+		std::vector<UUIDOp> uuidsOps; // Inserts into and erases from the simulation uuids map this tick
+		std::vector<QuadPointOp> quadtreeShipsOps; // Edits made to the simulation quadtrees this tick
+		std::vector<QuadAABBOp> quadtreePlanetoidsOps;
 		
 		QuadtreePoint quadtreeShips = {SpatialPartitioningSystem::MAX, SpatialPartitioningSystem::MAX, SpatialPartitioningSystem::MAX_ELEMENTS, SpatialPartitioningSystem::DEPTH};
 		QuadtreeAABB quadtreePlanetoids = {SpatialPartitioningPlanetoidsSystem::MAX, SpatialPartitioningPlanetoidsSystem::MAX, SpatialPartitioningPlanetoidsSystem::MAX_ELEMENTS, SpatialPartitioningPlanetoidsSystem::DEPTH};
@@ -62,14 +68,35 @@ class ShadowStarSystem {
 		ProfilerEvents profilerEvents;
 
 		void update();
+		// Remembers the changes of the tick source was just updated with, to be replayed the next time this becomes the working shadow
+		void addPending(ShadowStarSystem& source);
 		EntityReference getEntityReference(entt::entity entity);
 
 	private:
-		BitVector tmp;
-		BitVector tmpComponents[SYNCED_COMPONENTS_SEQ_SIZE];
+		HierarchicalBitVector tmpAdded;
+		HierarchicalBitVector tmpDeleted;
+		HierarchicalBitVector tmpComponents[SYNCED_COMPONENTS_SEQ_SIZE];
+		
+		// Changes made while this was not the working shadow
+		HierarchicalBitVector pendingAdded;
+		HierarchicalBitVector pendingChanged;
+		HierarchicalBitVector pendingComponents[SYNCED_COMPONENTS_SEQ_SIZE];
+		HierarchicalBitVector pendingDeleted;
+		std::vector<UUIDOp> pendingUuidsOps;
+		bool pendingUuidsCopy = false; // Too many edits to be worth replaying
+		std::vector<QuadPointOp> pendingQuadtreeShipsOps;
+		std::vector<QuadAABBOp> pendingQuadtreePlanetoidsOps;
+		bool pendingQuadtreeShipsCopy = false; // Too many edits to be worth replaying
+		bool pendingQuadtreePlanetoidsCopy = false;
 		
+		void replayUuids(const std::vector<UUIDOp>& ops);
 		void addComponents(uint32_t entityID, entt::entity entity);
-		void updateComponents(uint32_t entityID, entt::entity entity);
+		void syncComponents(uint32_t entityID, entt::entity entity);
+		template<typename Component>
+		void updateComponent(HierarchicalBitVector& entityIDs);
+		template<typename Component>
+		void copyPool();
+		static void updateComponentJob(void* data, uint32_t componentIndex);
 };
 
 #endif /* SRC_STARSYSTEMS_STARSYSTEM_SHADOW_HPP_ */
@@ -9,9 +9,11 @@
 
 #include <thread>
 #include <iostream>
+#include <bit>
 
 #include "Tracy.hpp"
 
+#include "Aurora.hpp"
 #include "starsystems/StarSystem.hpp"
 #include "starsystems/systems/Systems.hpp"
 #include "galaxy/Empire.hpp"
@@ -46,37 +48,68 @@ void registerComponentListeners(entt::registry& registry, StarSystem* starSystem
 	(registerComponentListener<Component>(registry, starSystem), ...); // c++ 17
 }
 
+StarSystem::~StarSystem() {
+	for (ShadowStarSystem* s : shadows) {
+		delete s;
+	}
+	
+	delete staticScheduler;
+	delete systems;
+	
+	if (current == this) {
+		current = nullptr;
+	}
+}
+
 void StarSystem::init(Galaxy* galaxy) {
 	StarSystem::galaxy = galaxy;
 	StarSystem::current = this;
+	time = galaxy->time;
 	
 	systems = new Systems();
 	
-	systems->movementPreSystem = scheduler.attach<MovementPreSystem>(this);
-//	scheduler.attach<ShipPreSystem>(this);
-//	scheduler.attach<TargetingPreSystem>(this);
-//	scheduler.attach<WeaponPreSystem>(this);
-//	scheduler.attach<PowerPreSystem>(this);
-	
-	systems->orbitSystem = scheduler.attach<OrbitSystem>(this);
-	systems->colonySystem = scheduler.attach<ColonySystem>(this);
-//	scheduler.attach<ShipSystem>(this);
-//	scheduler.attach<MovementPredictedSystem>(this);
-	systems->movementSystem = scheduler.attach<MovementSystem>(this);
-//	scheduler.attach<SolarIrradianceSystem>(this);
-//	scheduler.attach<PassiveSensorSystem>(this);
-//	scheduler.attach<TargetingSystem>(this);
-	systems->weaponSystem = scheduler.attach<WeaponSystem>(this);
-//	scheduler.attach<TimedLifeSystem>(this);
-	systems->spatialPartitioningSystem = scheduler.attach<SpatialPartitioningSystem>(this);
-	systems->spatialPartitioningPlanetoidsSystem = scheduler.attach<SpatialPartitioningPlanetoidsSystem>(this);
-	
-	scheduler.init(&systems);
+	if (Aurora.settings.systems.staticScheduler) {
+		staticScheduler = new SystemsScheduler(this);
+		systems->movementPreSystem = &staticScheduler->get<MovementPreSystem>();
+		systems->orbitSystem = &staticScheduler->get<OrbitSystem>();
+		systems->colonySystem = &staticScheduler->get<ColonySystem>();
+		systems->movementSystem = &staticScheduler->get<MovementSystem>();
+		systems->weaponSystem = &staticScheduler->get<WeaponSystem>();
+		systems->spatialPartitioningSystem = &staticScheduler->get<SpatialPartitioningSystem>();
+		systems->spatialPartitioningPlanetoidsSystem = &staticScheduler->get<SpatialPartitioningPlanetoidsSystem>();
+		staticScheduler->init(systems);
+		
+	} else {
+		systems->movementPreSystem = scheduler.attach<MovementPreSystem>(this);
+//		scheduler.attach<ShipPreSystem>(this);
+//		scheduler.attach<TargetingPreSystem>(this);
+//		scheduler.attach<WeaponPreSystem>(this);
+//		scheduler.attach<PowerPreSystem>(this);
+		
+		systems->orbitSystem = scheduler.attach<OrbitSystem>(this);
+		systems->colonySystem = scheduler.attach<ColonySystem>(this);
+//		scheduler.attach<ShipSystem>(this);
+//		scheduler.attach<MovementPredictedSystem>(this);
+		systems->movementSystem = scheduler.attach<MovementSystem>(this);
+//		scheduler.attach<SolarIrradianceSystem>(this);
+//		scheduler.attach<PassiveSensorSystem>(this);
+//		scheduler.attach<TargetingSystem>(this);
+		systems->weaponSystem = scheduler.attach<WeaponSystem>(this);
+//		scheduler.attach<TimedLifeSystem>(this);
+		systems->spatialPartitioningSystem = scheduler.attach<SpatialPartitioningSystem>(this);
+		systems->spatialPartitioningPlanetoidsSystem = scheduler.attach<SpatialPartitioningPlanetoidsSystem>(this);
+		
+		scheduler.init(systems);
+	}
 	
 	registerComponentListeners<SYNCED_COMPONENTS>(registry, this);
 	
-	shadow = new ShadowStarSystem(*this);
-	workingShadow = new ShadowStarSystem(*this);
+	for (ShadowStarSystem*& s : shadows) {
+		s = new ShadowStarSystem(*this);
+	}
+	
+	shadow = shadows[shadowIndex];
+	workingShadow = shadows[workingShadowIndex];
 	
 	Empire& gaia = galaxy->empires[0];
 	Empire& empire1 = galaxy->empires[1];
@@ -469,8 +502,9 @@ void StarSystem::added(entt::registry& registry, entt::entity entity) {
 	workingShadow->added[index] = true;
 	
 	if constexpr (std::is_same<Component, UUIDComponent>::value) {
-		uuids[registry.get<UUIDComponent>(entity).uuid] = entity;
-		workingShadow->uuidsChanged = true;
+		EntityUUID uuid = registry.get<UUIDComponent>(entity).uuid;
+		uuids[uuid] = entity;
+		workingShadow->uuidsOps.push_back({uuid, entity});
 	}
 }
 
@@ -482,8 +516,9 @@ void StarSystem::deleted(entt::registry& registry, entt::entity entity) {
 	workingShadow->deleted[index] = true;
 	
 	if constexpr (std::is_same<Component, UUIDComponent>::value) {
-		uuids.erase(registry.get<UUIDComponent>(entity).uuid);
-		workingShadow->uuidsChanged = true;
+		EntityUUID uuid = registry.get<UUIDComponent>(entity).uuid;
+		uuids.erase(uuid);
+		workingShadow->uuidsOps.push_back({uuid, entt::null});
 	}
 }
 
@@ -495,7 +530,7 @@ void StarSystem::changed2<component>(entt::entity entity) { \
 	workingShadow->changed.reserve(index + 1); \
 	workingShadow->changed[index] = true; \
 /*	BOOST_HANA_CONSTANT_ASSERT_MSG(hana::find(syncedComponentToIndexMap, hana::type_c<component>) != hana::nothing, "missing component mapping"); */ \
-	BitVector& changedVector = workingShadow->changedComponents[syncedComponentToIndexMap[hana::type_c<component>]]; \
+	HierarchicalBitVector& changedVector = workingShadow->changedComponents[syncedComponentToIndexMap[hana::type_c<component>]]; \
 	changedVector.reserve(index + 1); \
 	changedVector[index] = true; \
 };
@@ -510,16 +545,10 @@ void StarSystem::update(uint32_t deltaGameTime) {
 	ZoneScoped;
 	StarSystem::current = this;
 	
-	workingShadow->profiling = shadow->profiling;
+	workingShadow->profiling = profiling.load(std::memory_order_relaxed);
 	workingShadow->profilerEvents.clear();
 	auto strBuf = fmt::memory_buffer();
 	
-	if (workingShadow->profiling) {
-		scheduler.profilerEvents = &workingShadow->profilerEvents;
-	} else {
-		scheduler.profilerEvents = nullptr;
-	}
-	
 	PROFILE("shadow clear");
 	workingShadow->added.clear();
 	workingShadow->deleted.clear();
@@ -529,13 +558,11 @@ void StarSystem::update(uint32_t deltaGameTime) {
 		
 	} else {
 		workingShadow->changed.clear();
-		for (BitVector& bitVector : workingShadow->changedComponents) {
+		for (HierarchicalBitVector& bitVector : workingShadow->changedComponents) {
 			bitVector.clear();
 		}
 	}
 	
-	workingShadow->quadtreeShipsChanged = false;
-	workingShadow->quadtreePlanetoidsChanged = false;
 	PROFILE_End();
 	
 	PROFILE("commands");
@@ -549,38 +576,194 @@ void StarSystem::update(uint32_t deltaGameTime) {
 	PROFILE_End();
 	
 	PROFILE("processing");
-	
-	if (deltaGameTime <= 100) { //  || combatSubscription.entityCount > 0
-	
-		for (uint32_t i = 0; i < deltaGameTime; i++) {
-			PROFILE("process 1");
-			scheduler.update(1);
-			PROFILE_End();
+	auto process = [&](auto& scheduler) {
+		if (workingShadow->profiling) {
+			scheduler.profilerEvents = &workingShadow->profilerEvents;
+		} else {
+			scheduler.profilerEvents = nullptr;
 		}
 		
-	} else {
-		
-		uint32_t delta = 1 + deltaGameTime / 100;
-		
-		for (uint32_t i = 0; i < deltaGameTime / delta; i++) {
-			PROFILE2("process {}", delta);
-			scheduler.update(delta);
-			PROFILE_End();
-		}
+		const uint64_t targetTime = time + deltaGameTime;
+		uint64_t nativeTime = time; // When native processes were last given a chance to run
+		uint64_t nativeNext = scheduler.nextUpdate(ProcessSteps::NATIVE);
 		
-		for (uint32_t i = 0; i < deltaGameTime - delta * (deltaGameTime / delta); i++) {
-			PROFILE("process 1");
-			scheduler.update(1);
-			PROFILE_End();
+		// Jump straight to the next time any process has work instead of stepping through every second.
+		//  Native processes are only looked at when they are due, then everything runs in attach order so that
+		//  stepped processes attached after them see their results from the same step.
+		while (time < targetTime) {
+			uint64_t next = std::clamp(std::min(scheduler.nextUpdate(ProcessSteps::STEPPED), nativeNext), time + 1, targetTime);
+			uint32_t delta = next - time;
+			time = next;
+			
+			if (time >= nativeNext) {
+				PROFILE2("process {} native {}", delta, time - nativeTime);
+				scheduler.update(delta, time - nativeTime, ProcessSteps::ALL);
+				PROFILE_End();
+				
+				nativeTime = time;
+				nativeNext = scheduler.nextUpdate(ProcessSteps::NATIVE);
+				
+			} else {
+				PROFILE2("process {}", delta);
+				scheduler.update(delta, ProcessSteps::STEPPED);
+				PROFILE_End();
+			}
 		}
-		
-//			std::cout << "processing deltaGameTime  " << deltaGameTime << " = " << delta << " x " << deltaGameTime / delta << " + " << deltaGameTime - delta * (deltaGameTime / delta) << std::endl;
+	};
+	
+	if (staticScheduler != nullptr) {
+		process(*staticScheduler);
+	} else {
+		process(scheduler);
 	}
 	PROFILE_End();
 	
 	PROFILE("shadow update");
 	workingShadow->update();
 	PROFILE_End();
+	
+	publishShadow();
+}
+
+bool StarSystem::inCombat() {
+	return registry.view<LaserShotComponent>().size() > 0
+	    || registry.view<RailgunShotComponent>().size() > 0
+	    || registry.view<MissileComponent>().size() > 0;
+}
+
+// FNV-1a over the values in entity storage order
+static void hashValue(uint64_t& hash, int64_t value) {
+	for (uint8_t i = 0; i < 8; i++) {
+		hash ^= (value >> (i * 8)) & 0xFF;
+		hash *= 0x100000001b3;
+	}
+}
+
+static void hashFloat(uint64_t& hash, float value) {
+	hashValue(hash, (int64_t) std::bit_cast<uint32_t>(value));
+}
+
+static void hashFloat(uint64_t& hash, double value) {
+	hashValue(hash, std::bit_cast<int64_t>(value));
+}
+
+static void hashMovement(uint64_t& hash, const TimedValue<MovementValues>& value) {
+	hashValue(hash, value.time);
+	hashValue(hash, value.value.position.x());
+	hashValue(hash, value.value.position.y());
+	hashValue(hash, value.value.velocity.x());
+	hashValue(hash, value.value.velocity.y());
+	hashValue(hash, value.value.acceleration.x());
+	hashValue(hash, value.value.acceleration.y());
+}
+
+// Entity and hashed values of every Component, or only the entity for empty tag components
+template<typename Component, typename Func>
+static void hashComponents(uint64_t& hash, entt::registry& registry, Func hashComponent) {
+	auto view = registry.view<Component>();
+	hashValue(hash, (int64_t) view.size());
+	
+	for (entt::entity entity : view) {
+		hashValue(hash, (int64_t) entity);
+		
+		if constexpr (!std::is_empty_v<Component>) {
+			hashComponent(view.template get<Component>(entity));
+		}
+	}
+}
+
+uint64_t StarSystem::hashState() {
+	uint64_t hash = 0xcbf29ce484222325;
+	hashValue(hash, time);
+	
+	hashComponents<TimedMovementComponent>(hash, registry, [&](const TimedMovementComponent& movement) {
+		hashMovement(hash, movement.previous);
+		hashMovement(hash, movement.next);
+	});
+	
+	hashComponents<ThrustComponent>(hash, registry, [&](const ThrustComponent& thrust) {
+		hashValue(hash, (int64_t) thrust.thrust);
+		hashValue(hash, (int64_t) thrust.maxThrust);
+		// thrustAngle comes from a float atan2 which differs between compilers and CPUs, nothing in the simulation reads it
+		hashValue(hash, (int64_t) thrust.thrusting);
+	});
+	
+	hashComponents<MassComponent>(hash, registry, [&](const MassComponent& mass) {
+		hashFloat(hash, mass.mass);
+	});
+	
+	hashComponents<OrbitComponent>(hash, registry, [&](const OrbitComponent& orbit) {
+		hashValue(hash, (int64_t) orbit.parent);
+		hashFloat(hash, orbit.a_semiMajorAxis);
+		hashFloat(hash, orbit.e_eccentricity);
+		// Whole degrees stored as int16_t so these are exact
+		hashValue(hash, (int64_t) orbit.w_argumentOfPeriapsis);
+		hashValue(hash, (int64_t) orbit.M_meanAnomaly);
+	});
+	
+	hashComponents<MoveToEntityComponent>(hash, registry, [&](const MoveToEntityComponent& moveTo) {
+		hashValue(hash, (int64_t) moveTo.target);
+		hashValue(hash, (int64_t) moveTo.approach._to_integral());
+	});
+	
+	hashComponents<MoveToPositionComponent>(hash, registry, [&](const MoveToPositionComponent& moveTo) {
+		hashValue(hash, moveTo.target.x());
+		hashValue(hash, moveTo.target.y());
+		hashValue(hash, (int64_t) moveTo.approach._to_integral());
+	});
+	
+	hashComponents<OnPredictedMovementComponent>(hash, registry, [](const OnPredictedMovementComponent&) {});
+	
+	hashComponents<SpatialPartitioningComponent>(hash, registry, [&](const SpatialPartitioningComponent& spatial) {
+		hashValue(hash, (int64_t) spatial.nextExpectedUpdate);
+		hashValue(hash, (int64_t) spatial.elementID);
+	});
+	
+	hashComponents<SpatialPartitioningPlanetoidsComponent>(hash, registry, [&](const SpatialPartitioningPlanetoidsComponent& spatial) {
+		hashValue(hash, (int64_t) spatial.nextExpectedUpdate);
+		hashValue(hash, (int64_t) spatial.elementID);
+	});
+	
+	return hash;
+}
+
+void StarSystem::publishShadow() {
+	for (uint8_t i = 0; i < 3; i++) {
+		if (i != workingShadowIndex) {
+			shadows[i]->addPending(*workingShadow);
+		}
+	}
+	
+	workingShadow->uuidsOps.clear(); // Only here so that uuids added during init are kept until the first update
+	
+	uint8_t old = readyShadow.exchange(workingShadowIndex | SHADOW_NEW, std::memory_order_acq_rel);
+	workingShadowIndex = old & ~SHADOW_NEW;
+	workingShadow = shadows[workingShadowIndex];
+}
+
+bool StarSystem::promoteShadow() {
+	ZoneScoped;
+	assert(shadowReaders == 0);
+	
+	if (!(readyShadow.load(std::memory_order_acquire) & SHADOW_NEW)) {
+		return false;
+	}
+	
+	uint8_t old = readyShadow.exchange(shadowIndex, std::memory_order_acq_rel);
+	shadowIndex = old & ~SHADOW_NEW;
+	shadow = shadows[shadowIndex];
+	return true;
+}
+
+ShadowHandle::ShadowHandle(StarSystem& system)
+: system(system)
+{
+	system.shadowReaders++;
+	shadow = system.shadow;
+}
+
+ShadowHandle::~ShadowHandle() {
+	system.shadowReaders--;
 }
 
 bool StarSystem::operator<(const StarSystem& other) const {
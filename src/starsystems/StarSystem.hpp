@@ -8,7 +8,9 @@
 #ifndef SRC_STARSYSTEMS_STARSYSTEM_HPP_
 #define SRC_STARSYSTEMS_STARSYSTEM_HPP_
 
+#include <atomic>
 #include <chrono>
+#include <limits>
 #include <boost/circular_buffer.hpp>
 #include <unordered_map>
 
@@ -27,8 +29,27 @@ class StarSystem;
 class Galaxy;
 class ShadowStarSystem;
 class Systems;
+struct SystemsScheduler;
 class Empire;
 
+// Pins the shadow the UI reads from a star system for as long as it is alive, see StarSystem::acquireShadow.
+//  UI thread only. Handles are cheap, take one where a lock on galaxy->shadowLock used to be taken and pass it on to
+//  everything that reads the shadow instead of reading StarSystem::shadow.
+class ShadowHandle {
+	public:
+		ShadowHandle(StarSystem& system);
+		ShadowHandle(const ShadowHandle&) = delete;
+		ShadowHandle& operator=(const ShadowHandle&) = delete;
+		~ShadowHandle();
+		
+		ShadowStarSystem& operator*() const { return *shadow; }
+		ShadowStarSystem* operator->() const { return shadow; }
+		
+	private:
+		StarSystem& system;
+		ShadowStarSystem* shadow;
+};
+
 class StarSystem {
 	public:
 		static thread_local StarSystem* current; // thread_local has access penalty https://stackoverflow.com/questions/13106049/what-is-the-performance-penalty-of-c11-thread-local-variables-in-gcc-4-8
@@ -37,12 +58,16 @@ class StarSystem {
 		entt::entity galacticEntityID = entt::null;
 		nanoseconds updateTime = 0ns;
 		float updateTimeAverage = 0.0f;
+		uint64_t time = 0; // Game time simulated up to, the same as galaxy time between ticks
+		uint32_t homeWorker = 0; // Worker whose queue this system is pushed to each tick
+		uint32_t lastWorker = std::numeric_limits<uint32_t>::max(); // Worker that last updated this system
 		PCG32 random;
 		
 		boost::circular_buffer<Command*> commandQueue {128};
-		ShadowStarSystem* shadow = nullptr;
-		ShadowStarSystem* workingShadow = nullptr;
+		ShadowStarSystem* shadow = nullptr; // Only read and replaced by the UI thread, stays unchanged while any ShadowHandle is alive
+		ShadowStarSystem* workingShadow = nullptr; // Written by the simulation
 		bool skipClearShadowChanged = false;
+		std::atomic<bool> profiling = false; // Set by the UI, copied to each new working shadow
 		
 		Galaxy* galaxy = nullptr;
 		entt::registry registry;
@@ -53,13 +78,26 @@ class StarSystem {
 		}
 		StarSystem(const StarSystem&) = default;
 		StarSystem(StarSystem&&) = default;
+		~StarSystem();
 		
 		entt::entity createEnttiy(Empire& empire);
 		void destroyEntity(entt::entity entity);
 		
 		void init(Galaxy* galaxy);
 		void update(uint32_t deltaGameTime);
+		// Pins the shadow read by the UI. Lock free against the simulation, which only ever publishes into the two shadows not pinned here.
+		ShadowHandle acquireShadow() {
+			return ShadowHandle(*this);
+		}
+		// Makes the newest finished shadow the one read by the UI, returns false if there was none. Called by the UI once per
+		//  frame before input handling and rendering so that every layer and window reads the same tick. Never while shadow is pinned.
+		bool promoteShadow();
+		// True while there are shots or missiles in flight. Only call between ticks or from our own update.
+		bool inCombat();
+		// Hash of all simulation components, equal between runs when the simulation is deterministic. Only call between ticks.
+		uint64_t hashState();
 		Scheduler<std::uint32_t> scheduler;
+		SystemsScheduler* staticScheduler = nullptr; // Used instead of scheduler when set
 		
 		bool operator<(const StarSystem& other) const;
 		
@@ -83,6 +121,18 @@ class StarSystem {
 	private:
 		LoggerPtr log = Logger::getLogger("aurora.starsystem");
 		uint32_t entityUIDCounter = 0;
+		
+		// Triple buffered shadows: the simulation publishes finished shadows to readyShadow without waiting for the UI to let go of shadow
+		static constexpr uint8_t SHADOW_NEW = 0x4;
+		ShadowStarSystem* shadows[3] {};
+		uint8_t shadowIndex = 0;
+		uint8_t workingShadowIndex = 1;
+		std::atomic<uint8_t> readyShadow = 2;
+		uint32_t shadowReaders = 0; // Live ShadowHandles, UI thread only
+		
+		void publishShadow();
+		
+		friend class ShadowHandle;
 };
 
 std::ostream& operator<<(std::ostream& os, const StarSystem& s);
@@ -77,9 +77,10 @@ bool EntityReference::resolveReference(const StarSystem& starSystem) {
 	bool updated = false;
 	
 	for (StarSystem* system : Aurora.galaxy->systems) {
-		auto found = system->shadow->uuids.find(entityUUID);
+		ShadowHandle shadow = system->acquireShadow();
+		auto found = shadow->uuids.find(entityUUID);
 		
-		if (found != system->shadow->uuids.end()) {
+		if (found != shadow->uuids.end()) {
 			this->system = system;
 			entityID = found->second;
 			updated = true;
@@ -100,9 +101,10 @@ bool EntityReference::resolveReference(const StarSystem& starSystem) {
 
 bool EntityReference::resolveReference(const ShadowStarSystem& shadow) {
 	for (StarSystem* system : Aurora.galaxy->systems) {
-		auto found = system->shadow->uuids.find(entityUUID);
+		ShadowHandle shadow = system->acquireShadow();
+		auto found = shadow->uuids.find(entityUUID);
 		
-		if (found != system->shadow->uuids.end()) {
+		if (found != shadow->uuids.end()) {
 			this->system = system;
 			entityID = found->second;
 			return true;
@@ -51,17 +51,11 @@ struct TimedValue {
 		uint64_t time;
 };
 
-template<typename T>
-struct TimedComponent {
-		virtual TimedValue<T> get(uint64_t time) = 0;
-		
-		virtual ~TimedComponent() = default;
-};
-
 //TODO support multiple future points
 //TODO save old points
-template<typename T>
-struct InterpolatedComponent : public TimedComponent<T> {
+// Derived implements setValue and interpolate, and may hide setPrediction. Resolved at compile time so components have no vtable.
+template<typename T, typename Derived>
+struct InterpolatedComponent {
 		using Tval = TimedValue<T>;
 		
 		Tval previous;
@@ -75,8 +69,6 @@ struct InterpolatedComponent : public TimedComponent<T> {
 			next.time = 0;
 		}
 		
-		virtual void setValue(Tval& timedValue, const T& newValue) = 0;
-		
 		void set(T& value, uint64_t time) {
 			if (previous.time > time) {
 				return;
@@ -86,26 +78,24 @@ struct InterpolatedComponent : public TimedComponent<T> {
 				next.time = 0;
 			}
 			
-			setValue(previous, value);
+			derived().setValue(previous, value);
 			previous.time = time;
 		}
 		
-		virtual bool setPrediction(const  T& value, uint64_t time) {
+		bool setPrediction(const  T& value, uint64_t time) {
 	
 			if (previous.time >= time) {
 				next.time = 0; // why?
 				return false;
 			}
 	
-			setValue(next, value);
+			derived().setValue(next, value);
 			next.time = time;
 	
 			return true;
 		}
 	
-		virtual void interpolate(uint64_t time) = 0;
-
-		virtual Tval get(uint64_t time) override {
+		Tval get(uint64_t time) {
 			
 			if (time <= previous.time || next.time == 0) {
 				return previous;
@@ -116,27 +106,50 @@ struct InterpolatedComponent : public TimedComponent<T> {
 			}
 			
 			if (interpolated.time != time) {
-				interpolate(time);
+				derived().interpolate(time);
 				interpolated.time = time;
 			}
 			
 			return interpolated;
 		}
+		
+	private:
+		Derived& derived() {
+			return static_cast<Derived&>(*this);
+		}
 };
 
-struct RFKStruct(kodgen::ParseAllNested) TimedMovementComponent: InterpolatedComponent<MovementValues> {
+struct RFKStruct(kodgen::ParseAllNested) TimedMovementComponent: InterpolatedComponent<MovementValues, TimedMovementComponent> {
 	using Tval = TimedValue<MovementValues>;
 	ApproachType approach = ApproachType::COAST;
 	int64_t startAcceleration = 0; // = null
 	int64_t finalAcceleration = 0; // = null
 	Vector2l aimTarget = { 0, 0 }; // = null
 	
-	TimedMovementComponent() : InterpolatedComponent<MovementValues>(Tval { MovementValues {}, 0 }) {}
+	TimedMovementComponent() : InterpolatedComponent<MovementValues, TimedMovementComponent>(Tval { MovementValues {}, 0 }) {}
 	
-	virtual void setValue(Tval& timedValue, const MovementValues& newValue) override {
+	void setValue(Tval& timedValue, const MovementValues& newValue) {
 		timedValue.value = newValue;
 	}
 	
+	// Without a prediction the entity coasts at the velocity of previous. That is evaluated in closed form here
+	//  so coasting entities need no updates, and are only changed when their trajectory changes.
+	Tval get(uint64_t time) {
+		if (next.time == 0 && time > previous.time && !previous.value.velocity.isZero()) {
+			return { coast(time), time };
+		}
+		
+		return InterpolatedComponent::get(time);
+	}
+	
+	// Moves previous along the coasting trajectory to time, before integrating from previous
+	void coastTo(uint64_t time) {
+		if (next.time == 0 && time > previous.time && !previous.value.velocity.isZero()) {
+			previous.value = coast(time);
+			previous.time = time;
+		}
+	}
+	
 	TimedMovementComponent& set(int64_t x, int64_t y, int64_t vx, int64_t vy, int64_t ax, int64_t ay, uint64_t time)  {
 
 		if (previous.time > time) {
@@ -182,7 +195,7 @@ struct RFKStruct(kodgen::ParseAllNested) TimedMovementComponent: InterpolatedCom
 //		next.time = 0;
 //	}
 	
-	virtual bool setPrediction(const MovementValues& value, uint64_t time) override {
+	bool setPrediction(const MovementValues& value, uint64_t time) {
 
 		if (InterpolatedComponent::setPrediction(value, time)) {
 			approach = ApproachType::COAST;
@@ -260,7 +273,7 @@ struct RFKStruct(kodgen::ParseAllNested) TimedMovementComponent: InterpolatedCom
 		return false;
 	}
 
-	virtual void interpolate(uint64_t time) override {
+	void interpolate(uint64_t time) {
 
 		Vector2l& startPosition = previous.value.position;
 		Vector2l& endPosition = next.value.position;
@@ -320,7 +333,21 @@ struct RFKStruct(kodgen::ParseAllNested) TimedMovementComponent: InterpolatedCom
 	}
 	
 	TimedMovementComponent_GENERATED
+	
+	private:
+		MovementValues coast(uint64_t time) const {
+			const Vector2l& velocity = previous.value.velocity;
+			int64_t elapsed = time - previous.time;
+			
+			// velocity * elapsed / 100 split up so that long coasts at high speed do not overflow, rounds the same way
+			MovementValues values = previous.value;
+			values.position += (velocity / 100) * elapsed + ((velocity - (velocity / 100) * 100) * elapsed) / 100;
+			return values;
+		}
 };
 
+// Eigen vectors declare their own copy constructor so this can not be std::is_trivially_copyable, but without a vtable copies are plain member copies
+static_assert(!std::is_polymorphic_v<TimedMovementComponent> && std::is_trivially_destructible_v<TimedMovementComponent>);
+
 File_TimedComponents_GENERATED
 #endif /* SRC_STARSYSTEMS_COMPONENTS_TIMEDCOMPONENTS_HPP_ */
@@ -5,73 +5,180 @@
  *      Author: exuvo
  */
 
-#include <iostream>
+#include <cmath>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
+#include "Aurora.hpp"
 #include "starsystems/systems/Systems.hpp"
 #include "starsystems/components/Components.hpp"
 #include "utils/Utils.hpp"
+#include "utils/FixedPoint.hpp"
 
 void MovementPreSystem::init(void* data) {
 	Systems* systems = (Systems*) data;
 //	LOG4CXX_INFO(log, "init");
-	
+	movementSystem = systems->movementSystem;
 }
 
 void MovementPreSystem::update(delta_type delta) {
 //	LOG4CXX_INFO(log, "update");
 	
-	auto view = registry.view<TimedMovementComponent, ThrustComponent, MassComponent>(entt::exclude_t<OrbitComponent, OnPredictedMovementComponent>{});
+	auto view = registry.view<TimedMovementComponent, ThrustComponent, MassComponent>(entt::exclude_t<OrbitComponent>{});
+	nextThrustChange = NEVER;
 	
 	for (entt::entity entity : view) {
 		TimedMovementComponent& movement = view.get<TimedMovementComponent>(entity);
 		ThrustComponent& thrust = view.get<ThrustComponent>(entity);
 		
-		if (!registry.any_of<MoveToPositionComponent, MoveToEntityComponent>(entity)) {
-			thrust.thrusting = !movement.get(galaxy.time).value.velocity.isZero();
-
+		if (registry.all_of<OnPredictedMovementComponent>(entity)) {
+			// Predicted movements accelerate all the way to their arrival
+			thrust.thrusting = movement.next.time > starSystem.time;
+			
+			if (thrust.thrusting) {
+				nextThrustChange = std::min(nextThrustChange, movement.next.time);
+			}
+			
 		} else {
-			thrust.thrusting = true;
+			if (!registry.any_of<MoveToPositionComponent, MoveToEntityComponent>(entity)) {
+				thrust.thrusting = !movement.get(starSystem.time).value.velocity.isZero();
+				
+			} else {
+				thrust.thrusting = true;
+			}
+			
+			// Cleared again on the next update after the entity stops
+			if (thrust.thrusting) {
+				nextThrustChange = std::min(nextThrustChange, MovementPreSystem::IntervalSystem::nextUpdate());
+			}
 		}
 	}
 }
 
+uint64_t MovementPreSystem::nextUpdate() {
+	if (movementSystem->isMoving()) {
+		return MovementPreSystem::IntervalSystem::nextUpdate();
+	}
+	
+	// Otherwise thrusting only changes when a predicted movement arrives, or is still set from before an entity stopped
+	return nextThrustChange;
+}
+
+bool MovementSystem::isMoving() {
+	if (!movingChanged) {
+		return moving;
+	}
+	
+	movingChanged = false;
+	moving = false;
+	
+	// Without thrust an entity can only coast, which needs no updates
+	auto view = registry.view<TimedMovementComponent, ThrustComponent, MassComponent>(entt::exclude_t<OrbitComponent, OnPredictedMovementComponent>{});
+	
+	for (entt::entity entity : view) {
+		if (!view.get<TimedMovementComponent>(entity).previous.value.velocity.isZero() || registry.any_of<MoveToPositionComponent, MoveToEntityComponent>(entity)) {
+			moving = true;
+			break;
+		}
+	}
+	
+	return moving;
+}
+
+void MovementSystem::movementChanged(entt::registry &, entt::entity) {
+	movingChanged = true;
+}
+
 void MovementSystem::init(void* data) {
 	Systems* systems = (Systems*) data;
 //	LOG4CXX_INFO(log, "init");
 	weaponSystem = systems->weaponSystem;
+	
+	// Anything that can start an entity moving outside of update
+	registry.on_construct<MoveToPositionComponent>().connect<&MovementSystem::movementChanged>(this);
+	registry.on_construct<MoveToEntityComponent>().connect<&MovementSystem::movementChanged>(this);
+	registry.on_construct<ThrustComponent>().connect<&MovementSystem::movementChanged>(this);
+	registry.on_construct<MassComponent>().connect<&MovementSystem::movementChanged>(this);
+	registry.on_construct<TimedMovementComponent>().connect<&MovementSystem::movementChanged>(this);
+	registry.on_update<TimedMovementComponent>().connect<&MovementSystem::movementChanged>(this);
+	registry.on_destroy<OnPredictedMovementComponent>().connect<&MovementSystem::movementChanged>(this);
+	registry.on_destroy<OrbitComponent>().connect<&MovementSystem::movementChanged>(this);
 }
 
-void MovementSystem::update(delta_type delta) {
-//	LOG4CXX_INFO(log, "update");
+uint64_t MovementSystem::nextUpdate() {
+	if (isMoving()) {
+		return MovementSystem::IntervalSystem::nextUpdate();
+	}
 	
-	{
-		auto view1 = registry.view<TimedMovementComponent>(entt::exclude_t<ThrustComponent, MassComponent, MoveToEntityComponent, MoveToPositionComponent, OrbitComponent, OnPredictedMovementComponent>{});
+	// Predicted movements need no integration, only a look when they arrive
+	uint64_t next = NEVER;
+	auto view = registry.view<TimedMovementComponent, OnPredictedMovementComponent>();
+	
+	for (entt::entity entity : view) {
+		const TimedMovementComponent& movement = view.get<TimedMovementComponent>(entity);
 		
-		for (entt::entity entity : view1) {
-			TimedMovementComponent& movement = view1.get<TimedMovementComponent>(entity);
-			
-			if (movement.next.time != 0) {
-				LOG4CXX_ERROR(log, "Entity " << entity << " on predicted movement but does not have a OnPredictedMovementComponent");
-			}
-			
-			MovementValues shipMovementValue = movement.previous.value;
-			
-			auto& velocity = shipMovementValue.velocity;
-			
-			if (velocity.isZero()) {
-				continue;
-			}
-			
-			auto& position = shipMovementValue.position;
-			auto& acceleration = shipMovementValue.acceleration;
-			
-			position = position + (velocity * delta) / 100;
-			
-			movement.previous.time = galaxy.time;
-			starSystem.changed<TimedMovementComponent>(entity);
+		if (movement.next.time > starSystem.time) {
+			next = std::min(next, movement.next.time);
 		}
 	}
 	
+	return next;
+}
+
+namespace {
+	// One double lane at a time, for CPUs without AVX2 and the lanes left over after the AVX2 loop
+	struct ScalarLanes {
+		using Value = double;
+		using Mask = bool;
+		static constexpr size_t WIDTH = 1;
+		
+		static double load(const double* p) { return *p; }
+		static void store(double* p, double v) { *p = v; }
+		static double set(double v) { return v; }
+		static double sqrt(double v) { return std::sqrt(v); }
+		static double trunc(double v) { return std::trunc(v); }
+		static double select(bool mask, double a, double b) { return mask ? a : b; }
+		static bool lt(double a, double b) { return a < b; }
+		static bool le(double a, double b) { return a <= b; }
+		static bool gt(double a, double b) { return a > b; }
+		static bool eq(double a, double b) { return a == b; }
+		static bool both(bool a, bool b) { return a && b; }
+		static bool either(bool a, bool b) { return a || b; }
+		static bool andNot(bool a, bool b) { return !a && b; }
+	};
+	
+#if defined(__AVX2__)
+	// Four double lanes at a time, arithmetic through the GCC vector extension operators on __m256d
+	struct AVX2Lanes {
+		using Value = __m256d;
+		using Mask = __m256d;
+		static constexpr size_t WIDTH = 4;
+		
+		static __m256d load(const double* p) { return _mm256_loadu_pd(p); }
+		static void store(double* p, __m256d v) { _mm256_storeu_pd(p, v); }
+		static __m256d set(double v) { return _mm256_set1_pd(v); }
+		static __m256d sqrt(__m256d v) { return _mm256_sqrt_pd(v); }
+		static __m256d trunc(__m256d v) { return _mm256_round_pd(v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+		static __m256d select(__m256d mask, __m256d a, __m256d b) { return _mm256_blendv_pd(b, a, mask); }
+		static __m256d lt(__m256d a, __m256d b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+		static __m256d le(__m256d a, __m256d b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+		static __m256d gt(__m256d a, __m256d b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+		static __m256d eq(__m256d a, __m256d b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+		static __m256d both(__m256d a, __m256d b) { return _mm256_and_pd(a, b); }
+		static __m256d either(__m256d a, __m256d b) { return _mm256_or_pd(a, b); }
+		static __m256d andNot(__m256d a, __m256d b) { return _mm256_andnot_pd(a, b); }
+	};
+#endif
+}
+
+void MovementSystem::update(delta_type delta) {
+//	LOG4CXX_INFO(log, "update");
+	
+	// Entities without thrust coast, TimedMovementComponent::get evaluates them in closed form so they are never visited here
+	
+	deterministic = Aurora.settings.systems.deterministic;
+	
 	{
 		auto view2 = registry.view<TimedMovementComponent, ThrustComponent, MassComponent>(entt::exclude_t<MoveToPositionComponent, MoveToEntityComponent, OrbitComponent, OnPredictedMovementComponent>{});
 		
@@ -82,15 +189,16 @@ void MovementSystem::update(delta_type delta) {
 				LOG4CXX_ERROR(log, "Entity " << entity << " on predicted movement but does not have a OnPredictedMovementComponent");
 			}
 			
-			MovementValues shipMovementValue = movement.previous.value;
-			
-			auto& velocity = shipMovementValue.velocity;
-			
-			if (velocity.isZero()) {
+			if (movement.previous.value.velocity.isZero()) {
 				continue;
 			}
-				
+			
+			movement.coastTo(starSystem.time - delta); // May have been coasting since before it got thrusters
+			
+			MovementValues& shipMovementValue = movement.previous.value;
+			
 			auto& position = shipMovementValue.position;
+			auto& velocity = shipMovementValue.velocity;
 			auto& acceleration = shipMovementValue.acceleration;
 			
 			MassComponent& massComponent = view2.get<MassComponent>(entity);
@@ -100,18 +208,16 @@ void MovementSystem::update(delta_type delta) {
 			const auto massL = (long) mass;
 			
 			const auto currentAcceleration = (100 * thrustComponent.thrust) / massL;
-			const auto maxAcceleration = (100 * thrustComponent.maxThrust) / massL;
 			const auto tickAcceleration = currentAcceleration * delta;
-			const auto maxTickAcceleration = maxAcceleration * delta;
-			const auto velocityMagnitute = velocity.norm();
-
+			const int64_t velocityMagnitute = deterministic ? FixedPoint::norm(velocity) : velocity.norm();
+			
 			if (velocityMagnitute < (int64_t) tickAcceleration) {
-
+				
 				velocity = { 0,0 };
 				acceleration = { 0,0 };
 				
 			} else {
-
+				
 				// Apply breaking in same direction as travel
 				Vector2l tempVelocity = (velocity * -tickAcceleration ) / velocityMagnitute;
 				
@@ -128,15 +234,17 @@ void MovementSystem::update(delta_type delta) {
 				
 				tempVelocity = velocity * delta;
 				position += tempVelocity / 100;
-				movement.previous.time = galaxy.time;
+				movement.previous.time = starSystem.time;
 			}
-
-			registry.emplace_or_replace<TextComponent>(entity, "s " + (long) velocity.norm());
 			
-			starSystem.changed<TimedMovementComponent, ThrustComponent, TextComponent>(entity);
+			starSystem.changed<TimedMovementComponent, ThrustComponent>(entity);
 		}
 	}
 	
+	steering.clear();
+	arrived.clear();
+	predicted.clear();
+	
 	{
 		auto view3 = registry.view<TimedMovementComponent, ThrustComponent, MassComponent, MoveToPositionComponent>(entt::exclude_t<OrbitComponent, OnPredictedMovementComponent>{});
 		
@@ -169,20 +277,87 @@ void MovementSystem::update(delta_type delta) {
 			
 			MoveToEntityComponent& moveComponent = view4.get<MoveToEntityComponent>(entity);
 			TimedMovementComponent targetMovement = registry.get<TimedMovementComponent>(moveComponent.target);
-			MovementValues targetMovementValue = targetMovement.get(galaxy.time).value;
+			MovementValues targetMovementValue = targetMovement.get(starSystem.time).value;
 			
 			moveTo(entity, delta, movement, massComponent, thrustComponent, targetMovementValue.position, &targetMovementValue, moveComponent.target, moveComponent.approach);
 		}
 	}
+	
+	{
+		SteeringLanes& lanes = steering;
+		lanes.thrustX.resize(lanes.size());
+		lanes.thrustY.resize(lanes.size());
+		lanes.reached.resize(lanes.size());
+		
+		size_t i = 0;
+#if defined(__AVX2__)
+		i = steer<AVX2Lanes>(lanes, i, delta);
+#endif
+		steer<ScalarLanes>(lanes, i, delta);
+		
+		for (size_t i = 0; i < lanes.size(); i++) {
+			entt::entity entity = lanes.entities[i];
+			TimedMovementComponent& movement = *lanes.movements[i];
+			MovementValues& values = movement.previous.value;
+			
+			values.position = { (int64_t) lanes.positionX[i], (int64_t) lanes.positionY[i] };
+			values.velocity = { (int64_t) lanes.velocityX[i], (int64_t) lanes.velocityY[i] };
+			values.acceleration = { (int64_t) lanes.accelerationX[i], (int64_t) lanes.accelerationY[i] };
+			movement.previous.time = starSystem.time;
+			
+			if (lanes.reached[i] == 0) {
+				lanes.thrusts[i]->thrustAngle = std::atan2(lanes.thrustY[i], lanes.thrustX[i]);
+				starSystem.changed<TimedMovementComponent, ThrustComponent>(entity);
+				
+			} else {
+				arrived.push_back(entity);
+				starSystem.changed<TimedMovementComponent>(entity);
+			}
+		}
+	}
+	
+	// Structural changes last so the views above are not invalidated while iterating
+	for (entt::entity entity : arrived) {
+		registry.remove_if_exists<MoveToPositionComponent>(entity);
+		registry.remove_if_exists<MoveToEntityComponent>(entity);
+		LOG4CXX_DEBUG(log, "Movement: entity " << entity << " reached target");
+	}
+	
+	for (entt::entity entity : predicted) {
+		registry.emplace<OnPredictedMovementComponent>(entity);
+	}
+	
+	movingChanged = true;
+}
+
+void MovementSystem::SteeringLanes::clear() {
+	entities.clear();
+	movements.clear();
+	thrusts.clear();
+	positionX.clear();
+	positionY.clear();
+	velocityX.clear();
+	velocityY.clear();
+	accelerationX.clear();
+	accelerationY.clear();
+	targetX.clear();
+	targetY.clear();
+	targetVelocityX.clear();
+	targetVelocityY.clear();
+	currentAcceleration.clear();
+	tickAcceleration.clear();
+	maxAcceleration.clear();
+	maxTickAcceleration.clear();
+	ballistic.clear();
+	thrustX.clear();
+	thrustY.clear();
+	reached.clear();
 }
 
 void MovementSystem::moveTo(entt::entity entity, delta_type delta, TimedMovementComponent& movement, MassComponent& massComponent, ThrustComponent& thrustComponent, Vector2l targetPosition, MovementValues* targetMovement, entt::entity targetEntity, ApproachType approach) {
 	
-	MovementValues shipMovementValue = movement.previous.value;
-	
-	auto& velocity = shipMovementValue.velocity;
-	auto& position = shipMovementValue.position;
-	auto& acceleration = shipMovementValue.acceleration;
+	movement.coastTo(starSystem.time - delta);
+	const MovementValues& shipMovementValue = movement.previous.value;
 
 	const auto mass = massComponent.mass;
 	const auto massL = (long) mass;
@@ -192,220 +367,291 @@ void MovementSystem::moveTo(entt::entity entity, delta_type delta, TimedMovement
 	const auto tickAcceleration = currentAcceleration * delta;
 	const auto maxTickAcceleration = maxAcceleration * delta;
 	
-	Vector2l positionDiff = targetPosition - position;
-	const auto distance = positionDiff.norm();
-
-	//TODO if radiuses are touching we are done
-
-	// t = sqrt(2d / a)
-	// d = ut + 1/2at^2
-	// Base formula = t = sqrt(2d / a), Inital speed 0 and reaches target at speed
-	const auto timeToTraverseFrom0Velocity = 2 * sqrt((100 * distance) / maxTickAcceleration); 
-
-//		println("timeToTraverseFrom0Velocity ${TimeUnits.secondsToString(timeToTraverseFrom0Velocity.toLong())}")
-
-	if (timeToTraverseFrom0Velocity <= 1) {
-		position = targetPosition;
-		registry.remove_if_exists<MoveToPositionComponent>(entity);
-		registry.remove_if_exists<MoveToEntityComponent>(entity);
-		std::cout << "Movement: target reached distance";
-		starSystem.changed<TimedMovementComponent>(entity);
-		return;
-	}
-
 	const auto targetVelocity = targetMovement != nullptr ? targetMovement->velocity : Vector2l { 0,0 };
-	const auto targetVelocityMagnitude = targetVelocity.norm();
-	const auto angleToTarget = vectorsAngle(position, targetPosition);
-//		const auto velocityAngle = velocity.angle();
-	const auto velocityAngleDiffAngleToTarget = vectorsAngle(velocity, positionDiff);
-//		const auto targetVelocityAngle = targetVelocity.angle()
-	const auto velocityAngleScale = cos(vectorsAngle(targetVelocity, velocity));
-	const auto velocityMagnitute = (uint64_t) velocity.norm();
-	const auto timeToTargetWithCurrentSpeed = (100 * distance) / (velocityMagnitute + maxAcceleration);
-	const auto positionDiffMagnitude = (int64_t) positionDiff.norm();
-//		println("angleToTarget, $angleToTarget , velocityAngle $velocityAngle")
-
+	
 	switch (approach) {
 		case ApproachType::BRACHISTOCHRONE: {
-
-//		const auto relativeSpeed = targetMovement.value.velocity.cpy().sub(shipMovement.value.velocity).len() * FastMath.cos(targetMovement.value.velocity.angleToRad(shipMovement.value.velocity))
-			const auto timeToStop = (velocityMagnitute - velocityAngleScale * targetVelocityMagnitude) / maxAcceleration;
-
-//			println("timeToTargetWithCurrentSpeed ${timeToTargetWithCurrentSpeed}, timeToStop ${timeToStop}")
-//				println("angleToTarget, $angleToTarget, velocityAngle $velocityAngle, tempVelocityAngle ${tempVelocity.angle()}")
-
-//				if (timedMovement != null && (timedMovement.next == null || !timedMovement.next!!.value.position.equals(targetPosition))) {
-//
-//					timedMovement.setPredictionBallistic()
-//				}
-
-			Vector2l tempVelocity;
-			
-			if (timeToTargetWithCurrentSpeed < timeToStop && velocityMagnitute > 0) {
-
-				if (timeToStop <= 1) {
-					position = targetPosition;
-					velocity = { 0,0 };
-					acceleration = { 0,0 };
-					
-					registry.remove_if_exists<MoveToPositionComponent>(entity);
-					registry.remove_if_exists<MoveToEntityComponent>(entity);
-					
-					std::cout << "Movement: Brachistochrone target reached time";
-					registry.emplace_or_replace<TextComponent>(entity, "b " + (long) velocity.norm());
-					
-					starSystem.changed<TimedMovementComponent, TextComponent>(entity);
-					return;
-				}
-				
-				// Apply breaking in same direction as travel
-				tempVelocity = (velocity * -tickAcceleration ) / velocityMagnitute;
-				
-				if (tickAcceleration == currentAcceleration) {
-					acceleration = tempVelocity;
-					
-				} else {
-					acceleration = (velocity * -currentAcceleration) / velocityMagnitute;
-				}
-				
-				velocity += tempVelocity;
-				
-				thrustComponent.thrustAngle = vectorAngle(tempVelocity);
-				
-				registry.emplace_or_replace<TextComponent>(entity, "b " + (long) velocity.norm());
-
-			} else {
-
-				tempVelocity = (positionDiff* tickAcceleration) / positionDiffMagnitude;
-				
-				if (tickAcceleration == currentAcceleration) {
-					acceleration = tempVelocity;
-					
-				} else {
-					acceleration = (positionDiff * currentAcceleration) / positionDiffMagnitude;
-				}
-
-				if (velocityMagnitute > 10 * currentAcceleration) {
-					if (abs(velocityAngleDiffAngleToTarget) <= toRadians(90)) { // Thrust slightly sideways if velocity is only somewhat in the wrong direction
-						tempVelocity = vectorRotate(tempVelocity, velocityAngleDiffAngleToTarget);
-//							nameMapper.get(entityID).name = "< " + velocityAngleDiffAngleToTarget
-
-					} else { // Stop sideways velocity completly if is is too far off target
-						tempVelocity = vectorRotate(tempVelocity, std::numbers::pi - velocityAngleDiffAngleToTarget);
-//							nameMapper.get(entityID).name = "> " + velocityAngleDiffAngleToTarget + "," + (180 - velocityAngleDiffAngleToTarget)
-					}
-				}
-
-				velocity += tempVelocity;
-				
-				thrustComponent.thrustAngle = (float) vectorAngle(tempVelocity);
-				
-				registry.emplace_or_replace<TextComponent>(entity, "a " + (long) velocity.norm());
-				
-//					println("angleToTarget $angleToTarget, velocityAngle $velocityAngle, angleToTargetDiffVelocityAngle $angleToTargetDiffVelocityAngle, tickAcceleration $tickAcceleration cm/s, acceleration $acceleration cm/s, tempVelocity $tempVelocity, velocity $velocity, distance $distance")
-			}
-
-			tempVelocity = velocity * delta;
-			position += tempVelocity / 100;
-			
-			movement.previous.time = galaxy.time;
-
-//				println("tickAcceleration $tickAcceleration cm/s, acceleration $acceleration cm/s, velocity $velocity, distance $distance")
-			starSystem.changed<TimedMovementComponent, ThrustComponent, TextComponent>(entity);
 			break;
 		}
 		case ApproachType::BALLISTIC: {
-
-			registry.emplace_or_replace<TextComponent>(entity, "a " + velocityMagnitute);
-
-			if (movement.next.time == 0 && targetEntity != entt::null && velocityMagnitute == 0L) {
-
-				std::cout << "Movement: ballistic prediction to target";
-
-				const auto timeToTarget = sqrt((2 * 100 * distance) / (double) maxAcceleration);
-
-				const auto finalVelocity = maxAcceleration * timeToTarget;
-				
-				std::cout << "timeToTarget $timeToTarget, final velocity ${finalVelocity / 100} m/s, distance $distance, acceleration ${maxAcceleration} cm/s²";
-				
-				movement.previous.time = galaxy.time;
-				
-				MovementValues predictionMovVals = { targetPosition, vectorRotate(Vector2l{finalVelocity, 0}, angleToTarget), vectorRotate(Vector2l{maxAcceleration, 0}, angleToTarget) };
-				movement.setPredictionBallistic(predictionMovVals, targetPosition, maxAcceleration, galaxy.time + round(timeToTarget));
-				thrustComponent.thrustAngle = angleToTarget;
-				
-				registry.emplace<OnPredictedMovementComponent>(entity);
-				
-				starSystem.changed<TimedMovementComponent, ThrustComponent>(entity);
+			// Predictions interpolate with floating point, deterministic ships steer all the way instead
+			if (!deterministic && predictBallistic(entity, movement, thrustComponent, targetPosition, targetMovement, targetEntity, maxAcceleration)) {
 				return;
 			}
+			break;
+		}
+		default: {
+			throw std::runtime_error("Unknown approach type: $approach");
+		}
+	}
+	
+	if (deterministic) {
+		steerDeterministic(entity, delta, movement, thrustComponent, targetPosition, targetVelocity, currentAcceleration, maxAcceleration, approach == ApproachType::BALLISTIC);
+		return;
+	}
+	
+	SteeringLanes& lanes = steering;
+	lanes.entities.push_back(entity);
+	lanes.movements.push_back(&movement);
+	lanes.thrusts.push_back(&thrustComponent);
+	lanes.positionX.push_back(shipMovementValue.position.x());
+	lanes.positionY.push_back(shipMovementValue.position.y());
+	lanes.velocityX.push_back(shipMovementValue.velocity.x());
+	lanes.velocityY.push_back(shipMovementValue.velocity.y());
+	lanes.accelerationX.push_back(shipMovementValue.acceleration.x());
+	lanes.accelerationY.push_back(shipMovementValue.acceleration.y());
+	lanes.targetX.push_back(targetPosition.x());
+	lanes.targetY.push_back(targetPosition.y());
+	lanes.targetVelocityX.push_back(targetVelocity.x());
+	lanes.targetVelocityY.push_back(targetVelocity.y());
+	lanes.currentAcceleration.push_back(currentAcceleration);
+	lanes.tickAcceleration.push_back(tickAcceleration);
+	lanes.maxAcceleration.push_back(maxAcceleration);
+	lanes.maxTickAcceleration.push_back(maxTickAcceleration);
+	lanes.ballistic.push_back(approach == ApproachType::BALLISTIC);
+}
+
+// The steering kernel with integer math only, for the deterministic mode. Same decisions as steer() but the
+//  comparisons against the time to stop are cross multiplied and the sideways correction is rotated by exact fractions.
+void MovementSystem::steerDeterministic(entt::entity entity, delta_type delta, TimedMovementComponent& movement, ThrustComponent& thrustComponent, Vector2l targetPosition, Vector2l targetVelocity, int64_t currentAcceleration, int64_t maxAcceleration, bool ballistic) {
+	
+	MovementValues& values = movement.previous.value;
+	Vector2l& position = values.position;
+	Vector2l& velocity = values.velocity;
+	Vector2l& acceleration = values.acceleration;
+	
+	const int64_t tickAcceleration = currentAcceleration * delta;
+	const int64_t maxTickAcceleration = maxAcceleration * delta;
+	
+	const Vector2l positionDiff = targetPosition - position;
+	const int64_t distance = FixedPoint::norm(positionDiff);
+	const int64_t speed = FixedPoint::norm(velocity);
+	const int64_t timeToTargetWithCurrentSpeed = (100 * distance) / (speed + maxAcceleration);
+	
+	// timeToStop = (speed - cos(angle between velocities) * targetSpeed) / maxAcceleration = (speed² - targetVelocity·velocity) / (speed * maxAcceleration)
+	const __int128_t stopNumerator = (__int128_t) speed * speed - ((__int128_t) targetVelocity.x() * velocity.x() + (__int128_t) targetVelocity.y() * velocity.y());
+	const __int128_t stopDenominator = (__int128_t) speed * maxAcceleration;
+	
+	const bool reachedDistance = 100 * distance < maxTickAcceleration;
+	const bool braking = !ballistic && speed > 0 && timeToTargetWithCurrentSpeed * stopDenominator < stopNumerator;
+	const bool reachedStop = braking && stopNumerator <= stopDenominator;
+	const bool reachedBallistic = ballistic && timeToTargetWithCurrentSpeed <= 1;
+	
+	movement.previous.time = starSystem.time;
+	
+	if (reachedDistance || reachedStop || reachedBallistic) {
+		position = targetPosition;
+		
+		if (!reachedDistance && reachedStop) {
+			velocity = { 0, 0 };
+			acceleration = { 0, 0 };
+		}
+		
+		arrived.push_back(entity);
+		starSystem.changed<TimedMovementComponent>(entity);
+		return;
+	}
+	
+	Vector2l thrust;
+	
+	if (braking) {
+		thrust = (velocity * -tickAcceleration) / speed;
+		acceleration = tickAcceleration == currentAcceleration ? thrust : Vector2l((velocity * -currentAcceleration) / speed);
+		
+	} else {
+		thrust = (positionDiff * tickAcceleration) / distance;
+		
+		if (!ballistic) {
+			acceleration = tickAcceleration == currentAcceleration ? thrust : Vector2l((positionDiff * currentAcceleration) / distance);
+		}
+		
+		if (speed > 10 * currentAcceleration) {
+			// Rotate by the angle between velocity and target, or pi minus it when more than 90 degrees off
+			__int128_t cos = (__int128_t) velocity.x() * positionDiff.x() + (__int128_t) velocity.y() * positionDiff.y();
+			__int128_t sin = (__int128_t) velocity.x() * positionDiff.y() - (__int128_t) velocity.y() * positionDiff.x();
+			__int128_t norms = (__int128_t) speed * distance;
 			
-			if (movement.next.time == 0) { // && targetEntityID != null
-				
-				MovementValues targetMovementValue = targetMovement != nullptr ? *targetMovement : MovementValues(targetPosition, targetVelocity, Vector2l {0,0});
-				
-				const auto result = weaponSystem->getInterceptionPosition2(shipMovementValue, targetMovementValue, 0.0, maxAcceleration / 100.0);
-									
-				if (!result) {
-					
-					std::cout << "Unable to find ballistic intercept to target";
-					
-				} else {
-					
-					std::cout << "Movement: ballistic prediction to target";
-					
-					const auto [timeToIntercept, aimPosition, interceptPosition, interceptVelocity, relativeInterceptVelocity] = *result;
-					
-					std::cout << "timeToIntercept " << timeToIntercept << ", final velocity " << relativeInterceptVelocity.norm() << ", distance1 " << distance << ", distance2 " << (position - interceptPosition).norm() << ", acceleration " << maxAcceleration;
-					
-					const auto angleToAimTarget = vectorsAngle(position, aimPosition);
-					
-					movement.previous.time = galaxy.time;
-					
-					MovementValues predictionMovVals = { interceptPosition, interceptVelocity, vectorRotate(Vector2l(maxAcceleration, 0), angleToAimTarget) };
-					movement.setPredictionBallistic(predictionMovVals, aimPosition, maxAcceleration, galaxy.time + timeToIntercept);
-					thrustComponent.thrustAngle = angleToAimTarget;
-					
-					registry.emplace<OnPredictedMovementComponent>(entity);
-					
-					starSystem.changed<TimedMovementComponent, ThrustComponent>(entity);
-					return;
-				}
+			if (cos < 0) {
+				cos = -cos;
 			}
 			
-			if (timeToTargetWithCurrentSpeed <= 1) {
-
-				position = targetPosition;
-				registry.remove_if_exists<MoveToPositionComponent>(entity);
-				registry.remove_if_exists<MoveToEntityComponent>(entity);
-				std::cout << "Movement: Ballistic target reached time";
-				
-				starSystem.changed<TimedMovementComponent>(entity);
-				return;
-			}
-
-			Vector2l tempVelocity = (positionDiff * tickAcceleration) / positionDiffMagnitude;
-
-			if (velocityMagnitute > 10 * currentAcceleration) {
-				if (abs(velocityAngleDiffAngleToTarget) <= toRadians(90)) { // Thrust slightly sideways if velocity is only somewhat in the wrong direction
-					tempVelocity = vectorRotate(tempVelocity, velocityAngleDiffAngleToTarget);
+			thrust = Vector2l { (int64_t) ((cos * thrust.x() - sin * thrust.y()) / norms), (int64_t) ((sin * thrust.x() + cos * thrust.y()) / norms) };
+		}
+	}
+	
+	velocity += thrust;
+	position += (velocity * delta) / 100;
+	
+	thrustComponent.thrustAngle = vectorAngle(thrust); // Only for display
+	starSystem.changed<TimedMovementComponent, ThrustComponent>(entity);
+}
 
-				} else { // Stop sideways velocity completly if is is too far off target
-					tempVelocity = vectorRotate(tempVelocity, std::numbers::pi - velocityAngleDiffAngleToTarget);
-				}
-			}
+// Replaces steering with a predicted ballistic course when one can be found
+bool MovementSystem::predictBallistic(entt::entity entity, TimedMovementComponent& movement, ThrustComponent& thrustComponent, Vector2l targetPosition, MovementValues* targetMovement, entt::entity targetEntity, int64_t maxAcceleration) {
+	
+	const MovementValues& shipMovementValue = movement.previous.value;
+	const Vector2l& position = shipMovementValue.position;
+	const auto distance = (targetPosition - position).norm();
+	const auto angleToTarget = vectorsAngle(position, targetPosition);
+	
+	if (movement.next.time == 0 && targetEntity != entt::null && shipMovementValue.velocity.isZero()) {
 
-			velocity += tempVelocity;
-			thrustComponent.thrustAngle = vectorAngle(tempVelocity);
+		const auto timeToTarget = sqrt((2 * 100 * distance) / (double) maxAcceleration);
 
-			position += (velocity * delta) / 100;
+		const auto finalVelocity = maxAcceleration * timeToTarget;
+		
+		LOG4CXX_DEBUG(log, "Movement: ballistic prediction to target, timeToTarget " << timeToTarget << ", final velocity " << finalVelocity / 100 << " m/s, distance " << distance << ", acceleration " << maxAcceleration << " cm/s²");
+		
+		movement.previous.time = starSystem.time;
+		
+		MovementValues predictionMovVals = { targetPosition, vectorRotate(Vector2l{finalVelocity, 0}, angleToTarget), vectorRotate(Vector2l{maxAcceleration, 0}, angleToTarget) };
+		movement.setPredictionBallistic(predictionMovVals, targetPosition, maxAcceleration, starSystem.time + round(timeToTarget));
+		thrustComponent.thrustAngle = angleToTarget;
+		
+		predicted.push_back(entity);
+		
+		starSystem.changed<TimedMovementComponent, ThrustComponent>(entity);
+		return true;
+	}
+	
+	if (movement.next.time == 0) { // && targetEntityID != null
+		
+		const auto targetVelocity = targetMovement != nullptr ? targetMovement->velocity : Vector2l { 0,0 };
+		MovementValues targetMovementValue = targetMovement != nullptr ? *targetMovement : MovementValues(targetPosition, targetVelocity, Vector2l {0,0});
+		
+		const auto result = weaponSystem->getInterceptionPosition2(shipMovementValue, targetMovementValue, 0.0, maxAcceleration / 100.0);
+							
+		if (!result) {
+			
+			LOG4CXX_DEBUG(log, "Unable to find ballistic intercept to target");
+			
+		} else {
+			
+			const auto [timeToIntercept, aimPosition, interceptPosition, interceptVelocity, relativeInterceptVelocity] = *result;
+			
+			LOG4CXX_DEBUG(log, "Movement: ballistic prediction to target, timeToIntercept " << timeToIntercept << ", final velocity " << relativeInterceptVelocity.norm() << ", distance1 " << distance << ", distance2 " << (position - interceptPosition).norm() << ", acceleration " << maxAcceleration);
+			
+			const auto angleToAimTarget = vectorsAngle(position, aimPosition);
+			
+			movement.previous.time = starSystem.time;
+			
+			MovementValues predictionMovVals = { interceptPosition, interceptVelocity, vectorRotate(Vector2l(maxAcceleration, 0), angleToAimTarget) };
+			movement.setPredictionBallistic(predictionMovVals, aimPosition, maxAcceleration, starSystem.time + timeToIntercept);
+			thrustComponent.thrustAngle = angleToAimTarget;
+			
+			predicted.push_back(entity);
 			
 			starSystem.changed<TimedMovementComponent, ThrustComponent>(entity);
-			break;
-		}
-		default: {
-			throw std::runtime_error("Unknown approach type: $approach");
+			return true;
 		}
 	}
+	
+	return false;
 }
 
+// Brachistochrone and ballistic steering without branches, every lane computes all cases and selects its result.
+// Matches the integer math it replaced as long as the intermediate products stay below 2^53, except for the sideways
+//  correction which rotates by the cosine and sine of the angle directly instead of going through atan2.
+// Returns the index of the first lane not processed.
+template<typename Lanes>
+size_t MovementSystem::steer(SteeringLanes& lanes, size_t begin, double deltaValue) {
+	using V = typename Lanes::Value;
+	using M = typename Lanes::Mask;
+	
+	const V zero = Lanes::set(0), one = Lanes::set(1), two = Lanes::set(2), ten = Lanes::set(10), hundred = Lanes::set(100);
+	const V delta = Lanes::set(deltaValue);
+	size_t i = begin;
+	
+	for (; i + Lanes::WIDTH <= lanes.size(); i += Lanes::WIDTH) {
+		V px = Lanes::load(&lanes.positionX[i]);
+		V py = Lanes::load(&lanes.positionY[i]);
+		V vx = Lanes::load(&lanes.velocityX[i]);
+		V vy = Lanes::load(&lanes.velocityY[i]);
+		V ax = Lanes::load(&lanes.accelerationX[i]);
+		V ay = Lanes::load(&lanes.accelerationY[i]);
+		V tx = Lanes::load(&lanes.targetX[i]);
+		V ty = Lanes::load(&lanes.targetY[i]);
+		V tvx = Lanes::load(&lanes.targetVelocityX[i]);
+		V tvy = Lanes::load(&lanes.targetVelocityY[i]);
+		V currentAcceleration = Lanes::load(&lanes.currentAcceleration[i]);
+		V tickAcceleration = Lanes::load(&lanes.tickAcceleration[i]);
+		V maxAcceleration = Lanes::load(&lanes.maxAcceleration[i]);
+		V maxTickAcceleration = Lanes::load(&lanes.maxTickAcceleration[i]);
+		M ballistic = Lanes::gt(Lanes::load(&lanes.ballistic[i]), zero);
+		
+		V dx = tx - px;
+		V dy = ty - py;
+		V distanceExact = Lanes::sqrt(dx * dx + dy * dy);
+		V distance = Lanes::trunc(distanceExact);
+		V speedExact = Lanes::sqrt(vx * vx + vy * vy);
+		V speed = Lanes::trunc(speedExact);
+		V targetSpeedExact = Lanes::sqrt(tvx * tvx + tvy * tvy);
+		V targetSpeed = Lanes::trunc(targetSpeedExact);
+		
+		// Divisors for the brake and towards vectors, their lanes are never selected when zero but must not become NaN
+		V speedDivisor = Lanes::select(Lanes::gt(speed, zero), speed, one);
+		V distanceDivisor = Lanes::select(Lanes::gt(distance, zero), distance, one);
+		
+		// Cosine of the angle between the target and our velocity, 1 if either is zero like cos(atan2(0, 0))
+		V speeds = targetSpeedExact * speedExact;
+		V velocityAngleScale = Lanes::select(Lanes::gt(speeds, zero), (tvx * vx + tvy * vy) / speeds, one);
+		V timeToTargetWithCurrentSpeed = Lanes::trunc((hundred * distance) / (speed + maxAcceleration));
+		V timeToStop = (speed - velocityAngleScale * targetSpeed) / maxAcceleration;
+		
+		// 2 * sqrt(100 * distance / maxTickAcceleration) <= 1 with integer division
+		M reachedDistance = Lanes::lt(hundred * distance, maxTickAcceleration);
+		M braking = Lanes::andNot(ballistic, Lanes::both(Lanes::lt(timeToTargetWithCurrentSpeed, timeToStop), Lanes::gt(speed, zero)));
+		M reachedStop = Lanes::both(braking, Lanes::le(timeToStop, one));
+		M reachedBallistic = Lanes::both(ballistic, Lanes::le(timeToTargetWithCurrentSpeed, one));
+		M sameAcceleration = Lanes::eq(tickAcceleration, currentAcceleration);
+		
+		// Brake in the opposite direction of travel
+		V brakeX = Lanes::trunc((vx * -tickAcceleration) / speedDivisor);
+		V brakeY = Lanes::trunc((vy * -tickAcceleration) / speedDivisor);
+		V brakeAccelerationX = Lanes::select(sameAcceleration, brakeX, Lanes::trunc((vx * -currentAcceleration) / speedDivisor));
+		V brakeAccelerationY = Lanes::select(sameAcceleration, brakeY, Lanes::trunc((vy * -currentAcceleration) / speedDivisor));
+		
+		// Accelerate towards the target
+		V towardsX = Lanes::trunc((dx * tickAcceleration) / distanceDivisor);
+		V towardsY = Lanes::trunc((dy * tickAcceleration) / distanceDivisor);
+		V towardsAccelerationX = Lanes::select(sameAcceleration, towardsX, Lanes::trunc((dx * currentAcceleration) / distanceDivisor));
+		V towardsAccelerationY = Lanes::select(sameAcceleration, towardsY, Lanes::trunc((dy * currentAcceleration) / distanceDivisor));
+		
+		// When going fast thrust slightly sideways if velocity is only somewhat in the wrong direction,
+		//  or rotate by pi - angle to stop sideways velocity completely if it is more than 90 degrees off
+		V norms = Lanes::select(Lanes::gt(speedExact * distanceExact, zero), speedExact * distanceExact, one);
+		V cosAngle = (vx * dx + vy * dy) / norms;
+		V sinAngle = (vx * dy - vy * dx) / norms;
+		cosAngle = Lanes::select(Lanes::lt(cosAngle, zero), zero - cosAngle, cosAngle);
+		M turning = Lanes::gt(speed, ten * currentAcceleration);
+		V turnedX = Lanes::trunc(cosAngle * towardsX - sinAngle * towardsY);
+		V turnedY = Lanes::trunc(sinAngle * towardsX + cosAngle * towardsY);
+		towardsX = Lanes::select(turning, turnedX, towardsX);
+		towardsY = Lanes::select(turning, turnedY, towardsY);
+		
+		V thrustX = Lanes::select(braking, brakeX, towardsX);
+		V thrustY = Lanes::select(braking, brakeY, towardsY);
+		V newAx = Lanes::select(ballistic, ax, Lanes::select(braking, brakeAccelerationX, towardsAccelerationX));
+		V newAy = Lanes::select(ballistic, ay, Lanes::select(braking, brakeAccelerationY, towardsAccelerationY));
+		V newVx = vx + thrustX;
+		V newVy = vy + thrustY;
+		V newPx = px + Lanes::trunc((newVx * delta) / hundred);
+		V newPy = py + Lanes::trunc((newVy * delta) / hundred);
+		
+		// Snap to the target when there, stopping if it was reached by braking
+		M reached = Lanes::either(reachedDistance, Lanes::either(reachedStop, reachedBallistic));
+		M stopped = Lanes::andNot(reachedDistance, reachedStop);
+		
+		Lanes::store(&lanes.positionX[i], Lanes::select(reached, tx, newPx));
+		Lanes::store(&lanes.positionY[i], Lanes::select(reached, ty, newPy));
+		Lanes::store(&lanes.velocityX[i], Lanes::select(stopped, zero, Lanes::select(reached, vx, newVx)));
+		Lanes::store(&lanes.velocityY[i], Lanes::select(stopped, zero, Lanes::select(reached, vy, newVy)));
+		Lanes::store(&lanes.accelerationX[i], Lanes::select(stopped, zero, Lanes::select(reached, ax, newAx)));
+		Lanes::store(&lanes.accelerationY[i], Lanes::select(stopped, zero, Lanes::select(reached, ay, newAy)));
+		Lanes::store(&lanes.thrustX[i], thrustX);
+		Lanes::store(&lanes.thrustY[i], thrustY);
+		Lanes::store(&lanes.reached[i], Lanes::select(reached, Lanes::select(stopped, two, one), zero));
+	}
+	
+	return i;
+}
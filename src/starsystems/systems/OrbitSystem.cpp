@@ -10,6 +10,8 @@
 #include "utils/Math.hpp"
 
 constexpr double gravitationalConstant = 6.67408e-11;
+constexpr double gravitationalConstantKm = 6.67408e-20; // In km³/(kg s²)
+constexpr int MU_FRACTION_BITS = 32; // Fixed point μ so light parents like moons and asteroids keep their precision
 
 void OrbitSystem::init(void* data) {
 	Systems* systems = (Systems*) data;
@@ -28,6 +30,19 @@ void OrbitSystem::removed(entt::registry& registry, entt::entity entity) {
 	removedEntites.push_back(entity);
 }
 
+// Added and removed orbits are handled right away instead of waiting for the next day
+bool OrbitSystem::checkProcessing() {
+	return isActive() || !addedEntites.empty() || !removedEntites.empty();
+}
+
+uint64_t OrbitSystem::nextUpdate() {
+	if (!addedEntites.empty() || !removedEntites.empty()) {
+		return 0;
+	}
+	
+	return IntervalSystem::nextUpdate();
+}
+
 void OrbitSystem::update(delta_type delta) {
 //	LOG4CXX_INFO(log, "update");
 	
@@ -59,18 +74,22 @@ void OrbitSystem::update(delta_type delta) {
 		LOG4CXX_DEBUG(log, "Calculating orbit for new entity " << entityID << " using " << points << " points, orbitalPeriod " << orbitalPeriod / (24 * 60 * 60) << " days");
 		std::vector<Vector2l> orbitPoints = std::vector<Vector2l>(points);
 
+		// Shared by all orbits with the same eccentricity
+		const KeplerTable& kepler = keplerTables.try_emplace(orbit.e_eccentricity, orbit.e_eccentricity).first->second;
+		
 		// If set more dots represent higher speed, else the time between dots is constant
 		double invert = Aurora.settings.systems.orbits.dotsRepresentSpeed ? std::numbers::pi : 0.0;
 
 		for (uint32_t i=0; i<points; i++) {
 			double M_meanAnomaly = orbit.M_meanAnomaly + (360.0 * i) / points;
-			double E_eccentricAnomaly = calculateEccentricAnomalyFromMeanAnomaly(orbit, M_meanAnomaly) + invert;
+			double E_eccentricAnomaly = kepler.eccentricAnomaly(toRadians(M_meanAnomaly)) + invert;
 			orbitPoints[i] = calculateOrbitalPositionFromEccentricAnomaly(orbit, E_eccentricAnomaly);
 
 //			println("Calculated $i with M_meanAnomaly $M_meanAnomaly")
 		}
 		
-		orbitsCache[entityID] = OrbitCache(orbitalPeriod, apoapsis, periapsis, std::move(orbitPoints));
+		OrbitCache& orbitCache = orbitsCache[entityID] = OrbitCache(orbitalPeriod, apoapsis, periapsis, std::move(orbitPoints), &kepler);
+		setFixedPointElements(orbitCache, orbit, parentMass);
 
 		auto moonsSetIt = moonsCache.find(orbit.parent);
 		std::unordered_set<entt::entity>* moonsSet;
@@ -111,24 +130,65 @@ void OrbitSystem::update(delta_type delta) {
 	}
 }
 
+// Converts the orbital elements once so the deterministic mode never touches floating point after insertion.
+//  The products here are single IEEE operations, which round the same everywhere.
+void OrbitSystem::setFixedPointElements(OrbitCache& orbitCache, const OrbitComponent& orbit, const MassComponent& parentMass) {
+	orbitCache.semiMajorAxis = std::llround(Units::AU * orbit.a_semiMajorAxis);
+	orbitCache.eccentricity = orbit.e_eccentricity * (double) FixedPoint::ONE;
+	orbitCache.minorAxisScale = FixedPoint::sqrt(((unsigned __int128) 1 << (2 * FixedPoint::FRACTION_BITS)) - (__int128_t) orbitCache.eccentricity * orbitCache.eccentricity);
+	orbitCache.argumentOfPeriapsis = FixedPoint::fromDegrees(orbit.w_argumentOfPeriapsis);
+	orbitCache.meanAnomaly = FixedPoint::fromDegrees(orbit.M_meanAnomaly);
+	
+	// 2π sqrt(a³ / μ), scaled up before the square root to keep the fraction.
+	//  ldexp and round are exact so μ converts the same everywhere, and the 128 bit conversion fits the heaviest stars.
+	unsigned __int128 mu = std::max<unsigned __int128>((unsigned __int128) std::round(std::ldexp(parentMass.mass * gravitationalConstantKm, MU_FRACTION_BITS)), 1); // In km³/s², Q32
+	unsigned __int128 a3 = (unsigned __int128) orbitCache.semiMajorAxis * orbitCache.semiMajorAxis * orbitCache.semiMajorAxis;
+	int shift = 0;
+	
+	while (shift < 62 && a3 < ((unsigned __int128) 1 << 124)) {
+		a3 <<= 2;
+		shift++;
+	}
+	
+	// a3 / mu is a³ / μ scaled by 2^(2 shift - MU_FRACTION_BITS), the root by 2^(shift - MU_FRACTION_BITS / 2)
+	uint64_t root = FixedPoint::sqrt(a3 / mu);
+	orbitCache.period = std::max<uint64_t>(((unsigned __int128) root * FixedPoint::TWO_PI) >> (FixedPoint::TWO_PI_FRACTION_BITS + shift - MU_FRACTION_BITS / 2), 1);
+}
+
 void OrbitSystem::update(entt::entity entityID, OrbitComponent& orbit, TimedMovementComponent& movement) {
-	uint64_t today = galaxy.time;
+	uint64_t today = starSystem.time;
 	uint64_t dayLength = interval;
 	uint64_t tomorrow = today + dayLength;
 	
 	OrbitCache& orbitCache = orbitsCache[entityID];
-	double orbitalPeriod = orbitCache.orbitalPeriod;
-
-	double M_meanAnomalyToday =    orbit.M_meanAnomaly + 360 * ((today % (uint64_t) orbitalPeriod) / orbitalPeriod);
-	double M_meanAnomalyTomorrow = orbit.M_meanAnomaly + 360 * ((tomorrow % (uint64_t) orbitalPeriod) / orbitalPeriod);
-
+	Vector2l relativePosition;
+	Vector2l relativePositionTomorrow;
+	
+	if (Aurora.settings.systems.deterministic) {
+		uint64_t period = orbitCache.period;
+		
+		FixedPoint::Angle M_meanAnomalyToday =    orbitCache.meanAnomaly + (FixedPoint::Angle) (((unsigned __int128) (today % period) << 64) / period);
+		FixedPoint::Angle M_meanAnomalyTomorrow = orbitCache.meanAnomaly + (FixedPoint::Angle) (((unsigned __int128) (tomorrow % period) << 64) / period);
+		
+		relativePosition = calculateOrbitalPositionFromEccentricAnomaly(orbitCache, calculateEccentricAnomalyFromMeanAnomaly(orbitCache, M_meanAnomalyToday));
+		relativePositionTomorrow = calculateOrbitalPositionFromEccentricAnomaly(orbitCache, calculateEccentricAnomalyFromMeanAnomaly(orbitCache, M_meanAnomalyTomorrow));
+		
+	} else {
+		double orbitalPeriod = orbitCache.orbitalPeriod;
+		
+		double M_meanAnomalyToday =    orbit.M_meanAnomaly + 360 * ((today % (uint64_t) orbitalPeriod) / orbitalPeriod);
+		double M_meanAnomalyTomorrow = orbit.M_meanAnomaly + 360 * ((tomorrow % (uint64_t) orbitalPeriod) / orbitalPeriod);
+		
 //		println("M_meanAnomaly $M_meanAnomaly")
-
-	double E_eccentricAnomalyToday =    calculateEccentricAnomalyFromMeanAnomaly(orbit, M_meanAnomalyToday);
-	double E_eccentricAnomalyTomorrow = calculateEccentricAnomalyFromMeanAnomaly(orbit, M_meanAnomalyTomorrow);
+		
+		double E_eccentricAnomalyToday =    orbitCache.kepler->eccentricAnomaly(toRadians(M_meanAnomalyToday));
+		double E_eccentricAnomalyTomorrow = orbitCache.kepler->eccentricAnomaly(toRadians(M_meanAnomalyTomorrow));
+		
+		relativePosition = calculateOrbitalPositionFromEccentricAnomaly(orbit, E_eccentricAnomalyToday);
+		relativePositionTomorrow = calculateOrbitalPositionFromEccentricAnomaly(orbit, E_eccentricAnomalyTomorrow);
+	}
 	
 	// Today
-	Vector2l relativePosition = calculateOrbitalPositionFromEccentricAnomaly(orbit, E_eccentricAnomalyToday);
 	relativePosition *= 1000; // km to m
 
 	entt::entity parentEntity = orbit.parent;
@@ -143,8 +203,7 @@ void OrbitSystem::update(entt::entity entityID, OrbitComponent& orbit, TimedMove
 	movement.previous.time = today;
 	
 	// Tomorrow
-	relativePosition = calculateOrbitalPositionFromEccentricAnomaly(orbit, E_eccentricAnomalyTomorrow);
-	relativePosition *= 1000; // km to m
+	relativePosition = relativePositionTomorrow * 1000; // km to m
 	
 	TimedValue<MovementValues> parentMovementTomorrow = parentMovement.get(tomorrow);
 	parentPosition = parentMovementTomorrow.value.position;
@@ -152,7 +211,13 @@ void OrbitSystem::update(entt::entity entityID, OrbitComponent& orbit, TimedMove
 	Vector2l positionTomorrow = parentPosition + relativePosition;
 	
 	Vector2l newVelocity = positionTomorrow - positionToday;
-	newVelocity = (newVelocity.cast<double>() * 100.0 / interval).cast<int64_t>();
+	
+	if (Aurora.settings.systems.deterministic) {
+		newVelocity = (newVelocity * 100) / (int64_t) interval;
+		
+	} else {
+		newVelocity = (newVelocity.cast<double>() * 100.0 / interval).cast<int64_t>();
+	}
 	movement.previous.value.velocity = newVelocity;
 	
 	movement.setPrediction(MovementValues(positionTomorrow, newVelocity, Vector2l()), tomorrow);
@@ -160,40 +225,52 @@ void OrbitSystem::update(entt::entity entityID, OrbitComponent& orbit, TimedMove
 	starSystem.changed<TimedMovementComponent>(entityID);
 }
 
-double OrbitSystem::calculateEccentricAnomalyFromMeanAnomaly(OrbitComponent& orbit, double M_meanAnomaly) {
-	// Calculating orbits https://space.stackexchange.com/questions/8911/determining-orbital-position-at-a-future-point-in-time
-	double M_meanAnomalyRad = toRadians(M_meanAnomaly);
+Vector2l OrbitSystem::calculateOrbitalPositionFromEccentricAnomaly(OrbitComponent& orbit, double E_eccentricAnomaly) {
+	// Coordinates with P+ towards periapsis
+		double P = Units::AU * orbit.a_semiMajorAxis * (std::cos(E_eccentricAnomaly) - orbit.e_eccentricity);
+		double Q = Units::AU * orbit.a_semiMajorAxis * std::sin(E_eccentricAnomaly) * std::sqrt(1 - std::pow(orbit.e_eccentricity, 2.0));
+
+//		println("orbitalPeriod ${orbitalPeriod / (24 * 60 * 60)} days, E_eccentricAnomaly $E_eccentricAnomaly, P $P, Q $Q")
+
+		Vector2l position = { P, Q };
+		return vectorRotate(position, toRadians(orbit.w_argumentOfPeriapsis));
+}
 
-	// Solve numerically using Newtons method
-	double E_eccentricAnomaly = M_meanAnomalyRad;
+FixedPoint::Angle OrbitSystem::calculateEccentricAnomalyFromMeanAnomaly(const OrbitCache& orbit, FixedPoint::Angle M_meanAnomaly) {
+	// Newtons method like the floating point version, in turns instead of radians: E - e sin(E) / 2π - M = 0
+	FixedPoint::Angle E_eccentricAnomaly = M_meanAnomaly;
 	int attempts = 0;
 	while (true) {
-
-		double dE = (E_eccentricAnomaly - orbit.e_eccentricity * std::sin(E_eccentricAnomaly) - M_meanAnomalyRad) / (1.0 - orbit.e_eccentricity * std::cos(E_eccentricAnomaly));
+		
+		int64_t sin, cos;
+		FixedPoint::sinCos(E_eccentricAnomaly, sin, cos);
+		
+		int64_t eSinTurns = FixedPoint::multiply(FixedPoint::multiply(orbit.eccentricity, sin), FixedPoint::INVERSE_TWO_PI);
+		int64_t error = (int64_t) (E_eccentricAnomaly - M_meanAnomaly) - eSinTurns;
+		int64_t derivative = FixedPoint::ONE - FixedPoint::multiply(orbit.eccentricity, cos);
+		
+		int64_t dE = ((__int128_t) error * FixedPoint::ONE) / derivative;
 		E_eccentricAnomaly -= dE;
-
-//			println("dE $dE")
-
+		
 		attempts++;
-		if (std::abs(dE) < 1e-5) {
+		if (std::abs(dE) < (1LL << 24)) { // 1e-12 of a turn
 			break;
 		} else if (attempts >= 10) {
 			LOG4CXX_WARN(log, "Calculating orbital position took more than " << attempts << " attempts");
 			break;
 		}
 	}
-
+	
 	return E_eccentricAnomaly;
 }
 
-Vector2l OrbitSystem::calculateOrbitalPositionFromEccentricAnomaly(OrbitComponent& orbit, double E_eccentricAnomaly) {
+Vector2l OrbitSystem::calculateOrbitalPositionFromEccentricAnomaly(const OrbitCache& orbit, FixedPoint::Angle E_eccentricAnomaly) {
 	// Coordinates with P+ towards periapsis
-		double P = Units::AU * orbit.a_semiMajorAxis * (std::cos(E_eccentricAnomaly) - orbit.e_eccentricity);
-		double Q = Units::AU * orbit.a_semiMajorAxis * std::sin(E_eccentricAnomaly) * std::sqrt(1 - std::pow(orbit.e_eccentricity, 2.0));
-
-//		println("orbitalPeriod ${orbitalPeriod / (24 * 60 * 60)} days, E_eccentricAnomaly $E_eccentricAnomaly, P $P, Q $Q")
-
-		Vector2l position = { P, Q };
-		return vectorRotate(position, (double) orbit.w_argumentOfPeriapsis);
+	int64_t sin, cos;
+	FixedPoint::sinCos(E_eccentricAnomaly, sin, cos);
+	
+	int64_t P = FixedPoint::multiply(orbit.semiMajorAxis, cos - orbit.eccentricity);
+	int64_t Q = FixedPoint::multiply(FixedPoint::multiply(orbit.semiMajorAxis, sin), orbit.minorAxisScale);
+	
+	return FixedPoint::vectorRotate(Vector2l { P, Q }, orbit.argumentOfPeriapsis);
 }
-
@@ -2,7 +2,10 @@
 #define PROCESS_SCHEDULER_HPP
 
 #include <algorithm>
+#include <array>
+#include <limits>
 #include <memory>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -14,11 +17,23 @@
 
 #include "utils/Profiling.hpp"
 
+// Which processes Scheduler::update runs
+enum class ProcessSteps {
+	ALL,
+	STEPPED, // Processes that need to be stepped through each event of a tick
+	NATIVE, // Processes that handle the delta of a whole tick in one update
+};
+
 template<typename Derived, typename Delta>
 class Process {
 	public:
 		using delta_type = Delta;
 		
+		static constexpr uint64_t NEVER = std::numeric_limits<uint64_t>::max();
+		
+		// Set to true in processes that can integrate an arbitrary delta in one update
+		static constexpr bool NATIVE_DELTA = false;
+		
     /*! @brief Default destructor. */
     virtual ~Process() {
     	static_assert(std::is_base_of_v<Process, Derived>, "Incorrect use of the class template");
@@ -29,6 +44,10 @@ class Process {
     	return true;
     }
     void update(const Delta delta) const ENTT_NOEXCEPT {}
+    // Game time this process next has work at, 0 for as soon as possible and NEVER while idle
+    uint64_t nextUpdate() const ENTT_NOEXCEPT {
+    	return 0;
+    }
     
 	protected:
     
@@ -57,13 +76,13 @@ class Scheduler {
 		}
 		
 		template<typename Proc>
-		static void init(process_handler& handler, void* data) {
-			static_cast<Proc*>(handler.instance.get())->init(data);
+		static uint64_t nextUpdate(process_handler& handler) {
+			return static_cast<Proc*>(handler.instance.get())->nextUpdate();
 		}
 		
 		template<typename Proc>
-		static const std::string name() {
-			return type_name<Proc>();
+		static void init(process_handler& handler, void* data) {
+			static_cast<Proc*>(handler.instance.get())->init(data);
 		}
 	
 	public:
@@ -71,14 +90,16 @@ class Scheduler {
 				using instance_type = std::unique_ptr<void, void(*)(void*)>;
 				using isActive_fn_type = bool (process_handler&);
 				using update_fn_type = void (process_handler&, Delta);
+				using nextUpdate_fn_type = uint64_t (process_handler&);
 				using init_fn_type = void (process_handler&, void*);
-				using name_fn_type = const std::string (void);
 
 				instance_type instance;
 				isActive_fn_type* isActive;
 				update_fn_type* update;
+				nextUpdate_fn_type* nextUpdate;
 				init_fn_type* init;
-				name_fn_type* name;
+				uint16_t nameID; // In ProfilerNames
+				bool nativeDelta;
 		};
 
 		Scheduler() = default;
@@ -143,8 +164,10 @@ class Scheduler {
 			process_handler handler { std::move(instance_type), 
 				&Scheduler::isActive<Proc>, 
 				&Scheduler::update<Proc>, 
+				&Scheduler::nextUpdate<Proc>, 
 				&Scheduler::init<Proc>,
-				&Scheduler::name<Proc>
+				ProfilerNames::intern(type_name<Proc>()),
+				Proc::NATIVE_DELTA
 			};
 			
 			handlers.emplace_back(std::move(handler));
@@ -157,20 +180,48 @@ class Scheduler {
 			}
 		}
 		
+		/**
+		 * @brief Earliest game time any scheduled process has work at.
+		 * @param steps Which processes to consider.
+		 * @return 0 if a process wants to run as soon as possible, max if all are idle.
+		 */
+		uint64_t nextUpdate(ProcessSteps steps = ProcessSteps::ALL) {
+			uint64_t next = std::numeric_limits<uint64_t>::max();
+			
+			for (process_handler& handler : handlers) {
+				if (selected(handler, steps)) {
+					next = std::min(next, handler.nextUpdate(handler));
+				}
+			}
+			
+			return next;
+		}
+		
 		/**
 		 * @brief Updates all scheduled processes.
 		 *
 		 * All scheduled processes are executed in order.<br/>
 		 *
 		 * @param delta Elapsed time.
+		 * @param steps Which processes to run.
+		 */
+		void update(const Delta delta, ProcessSteps steps = ProcessSteps::ALL) {
+			update(delta, delta, steps);
+		}
+		
+		/**
+		 * @brief Updates scheduled processes, native ones with their own delta.
+		 * @param delta Elapsed time for stepped processes.
+		 * @param nativeDelta Elapsed time for native processes, which are not run on every step.
+		 * @param steps Which processes to run.
 		 */
-		void update(const Delta delta) {
+		void update(const Delta delta, const Delta nativeDelta, ProcessSteps steps) {
 			size_t size = handlers.size();
 			bool active[size];
 			
 			for (size_t i = 0; i < size; i++) {
 				process_handler& handler = handlers[i];
-				active[i] = handler.isActive(handler);
+				active[i] = selected(handler, steps) && handler.isActive(handler);
 			}
 			
 			if (!profilerEvents) {
@@ -178,7 +229,7 @@ class Scheduler {
 				for (size_t i = 0; i < size; i++) {
 					if (active[i]) {
 						process_handler& handler = handlers[i];
-						handler.update(handler, delta);
+						handler.update(handler, handler.nativeDelta ? nativeDelta : delta);
 					}
 				}
 				
@@ -191,10 +242,10 @@ class Scheduler {
 					if (active[i]) {
 						process_handler& handler = handlers[i];
 						ZoneScoped;
-						std::string name = handler.name();
-						ZoneText(name.c_str(), name.size());
-						profilerEvents->start(name);
-						handler.update(handler, delta);
+						const char* name = ProfilerNames::get(handler.nameID);
+						ZoneText(name, strlen(name));
+						profilerEvents->start(handler.nameID);
+						handler.update(handler, handler.nativeDelta ? nativeDelta : delta);
 						profilerEvents->end();
 					}
 				}
@@ -204,6 +255,98 @@ class Scheduler {
 		}
 		
 	private:
+		static bool selected(const process_handler& handler, ProcessSteps steps) {
+			return steps == ProcessSteps::ALL || handler.nativeDelta == (steps == ProcessSteps::NATIVE);
+		}
+};
+
+// Scheduler with a process set fixed at compile time. Processes live in a tuple and are called directly instead of
+//  through function pointers, which lets the compiler inline them. Always runs processes in order on the calling thread.
+template<typename Delta, typename ... Procs>
+class StaticScheduler {
+	public:
+		ProfilerEvents* profilerEvents = nullptr;
+		
+		// Every process is constructed from arg
+		template<typename Arg>
+		explicit StaticScheduler(Arg arg):
+			processes(((void) sizeof(Procs*), arg) ...),
+			nameIDs { ProfilerNames::intern(type_name<Procs>()) ... }
+		{
+			static_assert((std::is_base_of_v<Process<Procs, Delta>, Procs> && ...), "Invalid process type");
+		}
+		StaticScheduler(const StaticScheduler&) = delete;
+		
+		template<typename Proc>
+		Proc& get() {
+			return std::get<Proc>(processes);
+		}
+		
+		void init(void* data) {
+			std::apply([data](Procs& ... proc) {
+				(proc.init(data), ...);
+			}, processes);
+		}
+		
+		uint64_t nextUpdate(ProcessSteps steps = ProcessSteps::ALL) {
+			uint64_t next = std::numeric_limits<uint64_t>::max();
+			
+			std::apply([&](Procs& ... proc) {
+				((next = selected<Procs>(steps) ? std::min(next, proc.nextUpdate()) : next), ...);
+			}, processes);
+			
+			return next;
+		}
+		
+		void update(const Delta delta, ProcessSteps steps = ProcessSteps::ALL) {
+			update(delta, delta, steps);
+		}
+		
+		void update(const Delta delta, const Delta nativeDelta, ProcessSteps steps) {
+			// Like Scheduler all are checked before any is updated
+			const bool active[] { (selected<Procs>(steps) && std::get<Procs>(processes).checkProcessing()) ... };
+			
+			if (!profilerEvents) {
+				updateActive(delta, nativeDelta, active, std::index_sequence_for<Procs...>{});
+				
+			} else {
+				
+				ZoneScoped;
+				
+				profilerEvents->start("update");
+				updateActiveProfiled(delta, nativeDelta, active, std::index_sequence_for<Procs...>{});
+				profilerEvents->end();
+			}
+		}
+		
+	private:
+		std::tuple<Procs...> processes;
+		const std::array<uint16_t, sizeof...(Procs)> nameIDs; // In ProfilerNames
+		
+		template<typename Proc>
+		static constexpr bool selected(ProcessSteps steps) {
+			return steps == ProcessSteps::ALL || Proc::NATIVE_DELTA == (steps == ProcessSteps::NATIVE);
+		}
+		
+		template<size_t ... I>
+		void updateActive(const Delta delta, const Delta nativeDelta, const bool active[], std::index_sequence<I...>) {
+			((active[I] ? std::get<I>(processes).update(Procs::NATIVE_DELTA ? nativeDelta : delta) : void()), ...);
+		}
+		
+		template<size_t ... I>
+		void updateActiveProfiled(const Delta delta, const Delta nativeDelta, const bool active[], std::index_sequence<I...>) {
+			((active[I] ? updateProfiled<I>(Procs::NATIVE_DELTA ? nativeDelta : delta) : void()), ...);
+		}
+		
+		template<size_t I>
+		void updateProfiled(const Delta delta) {
+			ZoneScoped;
+			const char* name = ProfilerNames::get(nameIDs[I]);
+			ZoneText(name, strlen(name));
+			profilerEvents->start(nameIDs[I]);
+			std::get<I>(processes).update(delta);
+			profilerEvents->end();
+		}
 };
 
 #endif
@@ -25,6 +25,8 @@ void SpatialPartitioningPlanetoidsSystem::init(void* data) {
 	Systems* systems = (Systems*) data;
 //	LOG4CXX_INFO(log, "init");
 	
+	tree.journaling = true; // The shadows mirror the tree by replaying its journal
+	
 //	Aspect.all(CircleComponents).one(OrbitComponent::class.java, SunComponent::class.java, AsteroidComponent::class.java)
 	registry.on_construct<OrbitComponent>().connect<&SpatialPartitioningPlanetoidsSystem::inserted>(this);
 	registry.on_construct<SunComponent>().connect<&SpatialPartitioningPlanetoidsSystem::inserted>(this);
@@ -45,7 +47,7 @@ void SpatialPartitioningPlanetoidsSystem::removed(entt::registry& registry, entt
 
 void SpatialPartitioningPlanetoidsSystem::update(entt::entity entityID) {
 	TimedMovementComponent movementComponent = registry.get<TimedMovementComponent>(entityID);
-	MovementValues movement = movementComponent.get(galaxy.time).value;
+	MovementValues movement = movementComponent.get(starSystem.time).value;
 	CircleComponent& circle = registry.get<CircleComponent>(entityID);
 	
 	uint64_t nextExpectedUpdate = updateNextExpectedUpdate(entityID, movement, circle);
@@ -77,12 +79,11 @@ void SpatialPartitioningPlanetoidsSystem::update(entt::entity entityID) {
 	
 	PROFILE("insert");
 	partitioning.elementID = tree.insert(static_cast<uint32_t>(entityID), x - radius, y - radius, x + radius, y + radius);
-	starSystem.workingShadow->quadtreePlanetoidsChanged = true;
 	PROFILE_End();
 }
 
 uint64_t SpatialPartitioningPlanetoidsSystem::updateNextExpectedUpdate(entt::entity entityID, MovementValues& movement, CircleComponent circle) {
-	uint64_t nextExpectedUpdate = galaxy.time;
+	uint64_t nextExpectedUpdate = starSystem.time;
 		
 	if (!movement.velocity.isZero()) {
 		
@@ -103,7 +104,7 @@ uint64_t SpatialPartitioningPlanetoidsSystem::updateNextExpectedUpdate(entt::ent
 	if (nextExpectedUpdate == 0) {
 //		std::cout << "entityID " << entityID << ": nextExpectedUpdate " << nextExpectedUpdate << std::endl; 
 	} else {
-//		std::cout << "entityID " << entityID << ": nextExpectedUpdate " << nextExpectedUpdate - galaxy.time << std::endl;
+//		std::cout << "entityID " << entityID << ": nextExpectedUpdate " << nextExpectedUpdate - starSystem.time << std::endl;
 	}
 	
 	return nextExpectedUpdate;
@@ -122,7 +123,6 @@ void SpatialPartitioningPlanetoidsSystem::update(delta_type delta) {
 		
 		SpatialPartitioningPlanetoidsComponent& partitioning = registry.get<SpatialPartitioningPlanetoidsComponent>(entityID);
 		tree.remove(partitioning.elementID);
-		starSystem.workingShadow->quadtreePlanetoidsChanged = true;
 	}
 	removedEntites.clear();
 	
@@ -142,7 +142,7 @@ void SpatialPartitioningPlanetoidsSystem::update(delta_type delta) {
 				
 //				std::cout << "eval " << entityID << " " << partitioning.nextExpectedUpdate << std::endl;
 				
-				if (galaxy.time >= partitioning.nextExpectedUpdate) {
+				if (starSystem.time >= partitioning.nextExpectedUpdate) {
 				
 //					std::cout << "process " << entityID << " " << partitioning.nextExpectedUpdate << std::endl;
 					
@@ -162,12 +162,28 @@ void SpatialPartitioningPlanetoidsSystem::update(delta_type delta) {
 	}
 	
 	PROFILE("cleanup");
-	if (tree.cleanupFull()) {
-		starSystem.workingShadow->quadtreePlanetoidsChanged = true;
-	}
+	tree.cleanupFull();
 	PROFILE_End();
 }
 
+uint64_t SpatialPartitioningPlanetoidsSystem::nextUpdate() {
+	if (!addedEntites.empty() || !removedEntites.empty()) {
+		return 0;
+	}
+	
+	if (updateQueue.empty()) {
+		return NEVER;
+	}
+	
+	SpatialPartitioningPlanetoidsComponent* partitioning = registry.try_get<SpatialPartitioningPlanetoidsComponent>(updateQueue.top());
+	
+	if (partitioning == nullptr) { // Removed, let update clean it out of the queue
+		return 0;
+	}
+	
+	return partitioning->nextExpectedUpdate;
+}
+
 SmallList<entt::entity> SpatialPartitioningPlanetoidsSystem::query(QuadtreeAABB& quadTree, Matrix2l worldCoordinates) {
 	Matrix2i scaled = (worldCoordinates / SCALE).cast<int32_t>();
 	SmallList<uint32_t> entityIDs = quadTree.query(std::array<int32_t, 4>{ scaled(0, 0), scaled(0, 1), scaled(1, 0), scaled(1, 1) }, -1);
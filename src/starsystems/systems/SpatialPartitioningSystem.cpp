@@ -31,6 +31,8 @@ void SpatialPartitioningSystem::init(void* data) {
 	Systems* systems = (Systems*) data;
 //	LOG4CXX_INFO(log, "init");
 	
+	tree.journaling = true; // The shadows mirror the tree by replaying its journal
+	
 //	Aspect.all(TimedMovementComponent).one(ShipComponent, RailgunShotComponent, LaserShotComponent, MissileComponent);
 	registry.on_construct<ShipComponent>().connect<&SpatialPartitioningSystem::inserted>(this);
 	registry.on_construct<RailgunShotComponent>().connect<&SpatialPartitioningSystem::inserted>(this);
@@ -52,7 +54,7 @@ void SpatialPartitioningSystem::removed(entt::registry& registry, entt::entity e
 }
 
 void SpatialPartitioningSystem::update(entt::entity entityID) {
-	MovementValues movement = registry.get<TimedMovementComponent>(entityID).get(galaxy.time).value;
+	MovementValues movement = registry.get<TimedMovementComponent>(entityID).get(starSystem.time).value;
 	uint64_t nextExpectedUpdate = updateNextExpectedUpdate(entityID, movement);
 	
 	if (!registry.all_of<SpatialPartitioningComponent>(entityID)) {
@@ -80,12 +82,11 @@ void SpatialPartitioningSystem::update(entt::entity entityID) {
 	
 	PROFILE("insert");
 	partitioning.elementID = tree.insert(static_cast<uint32_t>(entityID), x, y);
-	starSystem.workingShadow->quadtreeShipsChanged = true;
 	PROFILE_End();
 }
 
 uint64_t SpatialPartitioningSystem::updateNextExpectedUpdate(entt::entity entityID, MovementValues& movement) {
-	uint64_t nextExpectedUpdate = galaxy.time;
+	uint64_t nextExpectedUpdate = starSystem.time;
 		
 	if (!movement.velocity.isZero()) {
 	
@@ -119,7 +120,7 @@ uint64_t SpatialPartitioningSystem::updateNextExpectedUpdate(entt::entity entity
 	if (nextExpectedUpdate == 0) {
 //			println("entityID $entityID: nextExpectedUpdate $nextExpectedUpdate")
 	} else {
-//			println("entityID $entityID: nextExpectedUpdate +${nextExpectedUpdate - galaxy.time}")
+//			println("entityID $entityID: nextExpectedUpdate +${nextExpectedUpdate - starSystem.time}")
 	}
 	
 	return nextExpectedUpdate;
@@ -138,7 +139,6 @@ void SpatialPartitioningSystem::update(delta_type delta) {
 		
 		SpatialPartitioningComponent& partitioning = registry.get<SpatialPartitioningComponent>(entityID);
 		tree.remove(partitioning.elementID);
-		starSystem.workingShadow->quadtreeShipsChanged = true;
 	}
 	removedEntites.clear();
 	
@@ -169,7 +169,7 @@ void SpatialPartitioningSystem::update(delta_type delta) {
 				
 //				println("eval $entityID ${partitioning.nextExpectedUpdate}")
 				
-				if (galaxy.time >= partitioning.nextExpectedUpdate) {
+				if (starSystem.time >= partitioning.nextExpectedUpdate) {
 				
 //					println("process $entityID ${partitioning.nextExpectedUpdate}")
 					
@@ -189,12 +189,28 @@ void SpatialPartitioningSystem::update(delta_type delta) {
 	}
 	
 	PROFILE("cleanup");
-	if (tree.cleanupFull()) {
-		starSystem.workingShadow->quadtreeShipsChanged = true;
-	}
+	tree.cleanupFull();
 	PROFILE_End();
 }
 
+uint64_t SpatialPartitioningSystem::nextUpdate() {
+	if (!addedEntites.empty() || !removedEntites.empty() || !accelerateObserver.empty()) {
+		return 0;
+	}
+	
+	if (updateQueue.empty()) {
+		return NEVER;
+	}
+	
+	SpatialPartitioningComponent* partitioning = registry.try_get<SpatialPartitioningComponent>(updateQueue.top());
+	
+	if (partitioning == nullptr) { // Removed, let update clean it out of the queue
+		return 0;
+	}
+	
+	return partitioning->nextExpectedUpdate;
+}
+
 SmallList<entt::entity> SpatialPartitioningSystem::query(QuadtreePoint& quadTree, Matrix2l worldCoordinates) {
 	Matrix2i scaled = (worldCoordinates / SCALE).cast<int32_t>();
 	SmallList<uint32_t> entityIDs = quadTree.query(std::array<int32_t, 4>{ scaled(0, 0), scaled(0, 1), scaled(1, 0), scaled(1, 1) }, -1);
@@ -21,6 +21,8 @@
 #include "galaxy/Galaxy.hpp"
 #include "starsystems/components/Components.hpp"
 #include "starsystems/systems/Scheduler.hpp"
+#include "utils/FixedPoint.hpp"
+#include "utils/KeplerTable.hpp"
 #include "utils/quadtree/QuadTreeAABB.hpp"
 #include "utils/quadtree/QuadTreePoint.hpp"
 
@@ -30,6 +32,7 @@
 using namespace log4cxx;
 
 struct Systems;
+class MovementSystem;
 class QuadtreePoint;
 class QuadtreeAABB;
 
@@ -53,21 +56,31 @@ class DailySystem : public BaseSystem<Derived> {
 	public:
 		DailySystem(uint32_t interval, StarSystem* starSystem) : DailySystem::BaseSystem(starSystem) {
 			this->interval = interval;
-			lastDay = this->galaxy.day;
+			lastDay = today();
 		}
 		bool isActive() {
-			if (this->galaxy.day - lastDay >= interval) {
-				lastDay = this->galaxy.day;
+			if (today() - lastDay >= interval) {
+				lastDay = today();
 				return true;
 			}
 			return false;
 		}
+		bool checkProcessing() {
+			return isActive();
+		}
+		uint64_t nextUpdate() const {
+			return (lastDay + interval) * 24L * 60L * 60L;
+		}
 		uint32_t getInterval() const {
 			return interval;
 		}
 	protected:
 		uint32_t lastDay;
 		uint32_t interval;
+		
+		uint32_t today() const {
+			return this->starSystem.time / (24L * 60L * 60L);
+		}
 };
 
 template<typename Derived>
@@ -75,15 +88,21 @@ class IntervalSystem : public BaseSystem<Derived> {
 	public:
 		IntervalSystem(seconds interval, StarSystem* starSystem): IntervalSystem::BaseSystem(starSystem) {
 			this->interval = interval.count();
-			lastTime = this->galaxy.time;
+			lastTime = this->starSystem.time;
 		}
 		bool isActive() {
-			if (this->galaxy.time - lastTime >= interval) {
-				lastTime = this->galaxy.time;
+			if (this->starSystem.time - lastTime >= interval) {
+				lastTime = this->starSystem.time;
 				return true;
 			}
 			return false;
 		}
+		bool checkProcessing() {
+			return isActive();
+		}
+		uint64_t nextUpdate() const {
+			return lastTime + interval;
+		}
 		uint32_t getInterval() const {
 			return interval;
 		}
@@ -106,6 +125,7 @@ class WeaponSystem : public IntervalSystem<WeaponSystem> {
 		
 		void init(void*);
 		void update(delta_type delta);
+		uint64_t nextUpdate();
 		
 		std::optional<InterceptResult> getInterceptionPosition5(MovementValues shooterMovement, MovementValues targetMovement, double missileLaunchSpeed, double missileStartAcceleration, double missileEndAcceleration, double missileAccelTime);
 		std::optional<InterceptResult> getInterceptionPosition4(MovementValues shooterMovement, MovementValues targetMovement, double missileLaunchSpeed, double missileAcceleration, double missileAccelTime);
@@ -124,9 +144,13 @@ class MovementPreSystem : public IntervalSystem<MovementPreSystem> {
 		
 		void init(void*);
 		void update(delta_type delta);
+		// Every interval while anything moves under thrust, otherwise at the earliest predicted arrival
+		uint64_t nextUpdate();
 		
 	private:
 		LoggerPtr log = Logger::getLogger("aurora.starsystems.systems.movement.pre");
+		MovementSystem* movementSystem = nullptr;
+		uint64_t nextThrustChange = 0; // From the last update, when thrusting changes while nothing moves
 };
 
 class MovementSystem : public IntervalSystem<MovementSystem> {
@@ -135,10 +159,47 @@ class MovementSystem : public IntervalSystem<MovementSystem> {
 		
 		void init(void*);
 		void update(delta_type delta);
+		uint64_t nextUpdate();
+		
+		// True if any entity needs its movement integrated each second, coasting entities never do.
+		// Only rescans after an update or a movement related component change
+		bool isMoving();
 		
 	private:
+		// Entities steering towards a move target this update, as double lanes for the steering kernel
+		struct SteeringLanes {
+				std::vector<entt::entity> entities;
+				std::vector<TimedMovementComponent*> movements;
+				std::vector<ThrustComponent*> thrusts;
+				std::vector<double> positionX, positionY;
+				std::vector<double> velocityX, velocityY;
+				std::vector<double> accelerationX, accelerationY;
+				std::vector<double> targetX, targetY;
+				std::vector<double> targetVelocityX, targetVelocityY;
+				std::vector<double> currentAcceleration, tickAcceleration, maxAcceleration, maxTickAcceleration;
+				std::vector<double> ballistic; // 1 for the ballistic approach, 0 for brachistochrone
+				std::vector<double> thrustX, thrustY; // Out, velocity change this update
+				std::vector<double> reached; // Out, 1 if at the target, 2 if also stopped there
+				
+				void clear();
+				size_t size() const { return entities.size(); }
+		};
+		
 		LoggerPtr log = Logger::getLogger("aurora.starsystems.systems.movement");
+		SteeringLanes steering;
+		std::vector<entt::entity> arrived; // Deferred removal of move components
+		std::vector<entt::entity> predicted; // Deferred OnPredictedMovementComponent
+		bool deterministic = false;
+		bool moving = false;
+		bool movingChanged = true;
+		
+		void movementChanged(entt::registry &, entt::entity);
+		// Queues entity for the steering kernel, or sets a ballistic prediction right away
 		void moveTo(entt::entity entity, delta_type delta, TimedMovementComponent& movement, MassComponent& massComponent, ThrustComponent& thrustComponent, Vector2l targetPos, MovementValues* targetMovement, entt::entity targetEntity, ApproachType approach);
+		bool predictBallistic(entt::entity entity, TimedMovementComponent& movement, ThrustComponent& thrustComponent, Vector2l targetPosition, MovementValues* targetMovement, entt::entity targetEntity, int64_t maxAcceleration);
+		template<typename Lanes>
+		static size_t steer(SteeringLanes& lanes, size_t begin, double delta);
+		void steerDeterministic(entt::entity entity, delta_type delta, TimedMovementComponent& movement, ThrustComponent& thrustComponent, Vector2l targetPosition, Vector2l targetVelocity, int64_t currentAcceleration, int64_t maxAcceleration, bool ballistic);
 		WeaponSystem* weaponSystem = nullptr;
 };
 
@@ -146,8 +207,12 @@ class OrbitSystem : public IntervalSystem<OrbitSystem> {
 	public:
 		OrbitSystem(StarSystem* starSystem) : OrbitSystem::IntervalSystem(24 * 60 * 60s, starSystem) {};
 		
+		static constexpr bool NATIVE_DELTA = true; // Positions are calculated from time
+		
 		void init(void*);
 		void update(delta_type delta);
+		bool checkProcessing();
+		uint64_t nextUpdate();
 		
 	private:
 		LoggerPtr log = Logger::getLogger("aurora.starsystems.systems.orbits");
@@ -157,9 +222,19 @@ class OrbitSystem : public IntervalSystem<OrbitSystem> {
 				double apoapsis;
 				double periapsis;
 				std::vector<Vector2l> orbitPoints;
+				const KeplerTable* kepler;
+				
+				// Fixed point orbital elements for the deterministic mode
+				uint64_t period; // In seconds
+				int64_t semiMajorAxis; // In km
+				int64_t eccentricity; // Q62
+				int64_t minorAxisScale; // sqrt(1 - e²) in Q62
+				FixedPoint::Angle argumentOfPeriapsis;
+				FixedPoint::Angle meanAnomaly;
 		};
 		
 		std::unordered_map<entt::entity, OrbitCache> orbitsCache;
+		std::unordered_map<float, KeplerTable> keplerTables; // By eccentricity
 		std::unordered_map<entt::entity, std::unordered_set<entt::entity>> moonsCache;
 		std::vector<entt::entity> addedEntites;
 		std::vector<entt::entity> removedEntites;
@@ -167,8 +242,10 @@ class OrbitSystem : public IntervalSystem<OrbitSystem> {
 		void inserted(entt::registry &, entt::entity);
 		void removed(entt::registry &, entt::entity);
 		void update(entt::entity, OrbitComponent& orbit, TimedMovementComponent& movement);
-		double calculateEccentricAnomalyFromMeanAnomaly(OrbitComponent& orbit, double M_meanAnomaly);
 		Vector2l calculateOrbitalPositionFromEccentricAnomaly(OrbitComponent& orbit, double E_eccentricAnomaly);
+		FixedPoint::Angle calculateEccentricAnomalyFromMeanAnomaly(const OrbitCache& orbit, FixedPoint::Angle M_meanAnomaly);
+		Vector2l calculateOrbitalPositionFromEccentricAnomaly(const OrbitCache& orbit, FixedPoint::Angle E_eccentricAnomaly);
+		void setFixedPointElements(OrbitCache& orbitCache, const OrbitComponent& orbit, const MassComponent& parentMass);
 };
 
 class SpatialPartitioningSystem : public IntervalSystem<SpatialPartitioningSystem> {
@@ -177,6 +254,7 @@ class SpatialPartitioningSystem : public IntervalSystem<SpatialPartitioningSyste
 		
 		void init(void*);
 		void update(delta_type delta);
+		uint64_t nextUpdate();
 		static SmallList<entt::entity> query(QuadtreePoint& quadTree, Matrix2l worldCoordinates);
 		
 		static constexpr int32_t SCALE = 2000; // in m , min 1000
@@ -217,6 +295,7 @@ class SpatialPartitioningPlanetoidsSystem : public IntervalSystem<SpatialPartiti
 		
 		void init(void*);
 		void update(delta_type delta);
+		uint64_t nextUpdate();
 		static SmallList<entt::entity> query(QuadtreeAABB& quadTree, Matrix2l worldCoordinates);
 		
 		static constexpr int32_t SCALE = 2000; // in m , min 1000
@@ -254,6 +333,8 @@ class ColonySystem : public IntervalSystem<ColonySystem> {
 	public:
 		ColonySystem(StarSystem* starSystem) : ColonySystem::IntervalSystem(60 * 60s, starSystem) {};
 		
+		static constexpr bool NATIVE_DELTA = true;
+		
 		void init(void*);
 		void update(delta_type delta);
 		
@@ -271,4 +352,9 @@ struct Systems {
 		OrbitSystem* orbitSystem = nullptr;
 };
 
+// The star system processes in update order, for StarSystem with static dispatch
+struct SystemsScheduler : public StaticScheduler<uint32_t, MovementPreSystem, OrbitSystem, ColonySystem, MovementSystem, WeaponSystem, SpatialPartitioningSystem, SpatialPartitioningPlanetoidsSystem> {
+		using SystemsScheduler::StaticScheduler::StaticScheduler;
+};
+
 #endif /* SRC_STARSYSTEMS_SYSTEMS_SYSTEMS_HPP_ */
@@ -19,6 +19,10 @@ void WeaponSystem::init(void* data) {
 
 void WeaponSystem::update(delta_type delta) {
 	
+}
+
+uint64_t WeaponSystem::nextUpdate() {
+	return starSystem.inCombat() ? WeaponSystem::IntervalSystem::nextUpdate() : NEVER;
 }
 
 	/**
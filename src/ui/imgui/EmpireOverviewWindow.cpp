@@ -77,7 +77,8 @@ void EmpireOverviewWindow::render() {
 			for (StarSystem* system : Player::current->visibleSystems) {
 				if (ImGui::TreeNodeEx(std::to_string((entt::id_type) system->galacticEntityID).c_str(), ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_NoTreePushOnOpen, system->name.c_str())) {
 					
-					ShadowStarSystem& shadow = *system->shadow;
+					ShadowHandle shadowHandle = system->acquireShadow();
+					ShadowStarSystem& shadow = *shadowHandle;
 					
 					auto drawIcon = [&](entt::entity entityID, StrategicIconComponent& icon, bool selected) {
 						if (window->SkipItems) {
@@ -139,8 +140,6 @@ void EmpireOverviewWindow::render() {
 					
 					(void) drawIcon; //TODO remove when drawIcon is used
 					
-					std::unique_lock<LockableBase(std::mutex)> lock(Aurora.galaxy->shadowLock);
-					
 					std::vector<EntityReference> systemColonies(empire->colonies.size());
 					
 					for (EntityReference& ref : empire->colonies) {
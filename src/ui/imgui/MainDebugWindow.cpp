@@ -5,11 +5,13 @@
  *      Author: exuvo
  */
 
+#include <cinttypes>
 #include <imgui.h>
 #include <imgui_internal.h>
 
 #include "Aurora.hpp"
 #include "MainDebugWindow.hpp"
+#include "galaxy/Galaxy.hpp"
 #include "ui/imgui/ImGuiDemoWindow.hpp"
 #include "ui/imgui/ImGuiLayer.hpp"
 #include "utils/Utils.hpp"
@@ -38,6 +40,7 @@ void MainDebugWindow::render() {
 				ImGui::MenuItem("useShadow", "", &Aurora.settings.render.useShadow, true);
 				ImGui::MenuItem("debugSpatialPartitioning", "", &Aurora.settings.render.debugSpatialPartitioning, true);
 				ImGui::MenuItem("debugSpatialPartitioningPlanetoids", "", &Aurora.settings.render.debugSpatialPartitioningPlanetoids, true);
+				ImGui::MenuItem("debugSpeedLabels", "", &Aurora.settings.render.debugSpeedLabels, true);
 				ImGui::EndMenu();
 			}
 			ImGui::EndMenuBar();
@@ -51,6 +54,7 @@ void MainDebugWindow::render() {
 //		ImGui::Text("ctx.navWindow.dc %ul" , ctx->NavWindow != nullptr ? ctx->NavWindow->DC : 0);
 		ImGui::Text("ctx.io.wantCaptureMouse %u", ctx->IO.WantCaptureMouse);
 		ImGui::Text("ctx.io.wantCaptureKeyboard %u", ctx->IO.WantCaptureKeyboard);
+		ImGui::Text("galaxy.systemMigrations %" PRIu64 ", stolen jobs %" PRIu64, Aurora.galaxy->systemMigrations.load(), Aurora.galaxy->jobs.getStolenCount());
 		float graphValues[] = { 0, 5, 2, 4 };
 		ImGui::PlotLines("plot", graphValues, ARRAY_LEN(graphValues), 0, nullptr, 0, 5, {}, 1);
 
@@ -23,9 +23,9 @@ void ProfilerWindow::render() {
 		
 		if (starSystem != oldStarSystem) {
 			if (oldStarSystem != nullptr) {
-				oldStarSystem->shadow->profiling = false;
+				oldStarSystem->profiling = false;
 			}
-			starSystem->shadow->profiling = true;
+			starSystem->profiling = true;
 			oldStarSystem = starSystem;
 		}
 		
@@ -84,16 +84,16 @@ void ProfilerWindow::render() {
 			const ProfilerEvent& startEvent = events[idx++];
 			const ProfilerEvent* endEvent = &events[idx];
 			
-			while (endEvent->name[0] != '\0') {
+			while (!endEvent->isEnd()) {
 				y += 15;
 				idx = drawNestedEvents(events, idx);
 				y -= 15;
 				endEvent = &events[idx];
 			}
 			
-			if (eventBar(startEvent.time.count() - timeOffset, endEvent->time.count() - timeOffset, startEvent.name)) {
+			if (eventBar(startEvent.time.count() - timeOffset, endEvent->time.count() - timeOffset, startEvent.getName())) {
 				strBuf.clear();
-				fmt::format_to(std::back_inserter(strBuf), "{} {:u}{}", startEvent.name, endEvent->time - startEvent.time, '\0');
+				fmt::format_to(std::back_inserter(strBuf), "{} {:u}{}", startEvent.getName(), endEvent->time - startEvent.time, '\0');
 				ImGui::SetTooltip(strBuf.data());
 			}
 			
@@ -210,10 +210,16 @@ void ProfilerWindow::render() {
 				}
 			}
 			
+			std::unique_lock<LockableBase(std::mutex)> lock(Aurora.galaxy->shadowLock);
 			ProfilerEvents& galaxyEvents = Aurora.galaxy->shadow->profilerEvents;
 			
 			strBuf.clear();
 			fmt::format_to(std::back_inserter(strBuf), "Galaxy {} events", galaxyEvents.size());
+			
+			for (const ProfilerEvent& metric : galaxyEvents.getMetrics()) {
+				fmt::format_to(std::back_inserter(strBuf), ", {} {}us", metric.name, metric.time.count() / 1000.0);
+			}
+			
 			ImGui::TextUnformatted(strBuf.data(), strBuf.data() + strBuf.size());
 			
 			if (galaxyEvents.size() > 0) {
@@ -224,7 +230,8 @@ void ProfilerWindow::render() {
 				
 				uint8_t i = 0;
 				for (const StarSystem* system : Aurora.galaxy->systems) {
-					ProfilerEvents& events = system->shadow->profilerEvents;
+					ShadowHandle shadow = system->acquireShadow();
+					ProfilerEvents& events = shadow->profilerEvents;
 					
 					strBuf.clear();
 					// system->registry.entity(system->galacticEntityID)
@@ -240,7 +247,7 @@ void ProfilerWindow::render() {
 		ImGui::EndChild();
 		
 	} else {
-		starSystem->shadow->profiling = false;
+		starSystem->profiling = false;
 	}
 	
 	ImGui::End();
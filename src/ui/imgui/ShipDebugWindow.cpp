@@ -5,6 +5,7 @@
  *      Author: exuvo
  */
 
+#include <optional>
 #include <Refureku/Refureku.h>
 
 #include "ShipDebugWindow.hpp"
@@ -152,8 +153,10 @@ void ShipDebugWindow::render() {
 				EntityReference* entityRef = &selectedEntities[selectionIndex];
 				
 				if (Aurora.settings.render.useShadow) {
-					if (!entityRef->isValid(*entityRef->system->shadow)) {
-						if (entityRef->resolveReference(*entityRef->system->shadow)) {
+					ShadowHandle shadow = entityRef->system->acquireShadow();
+					
+					if (!entityRef->isValid(*shadow)) {
+						if (entityRef->resolveReference(*shadow)) {
 							Player::current->replaceSelection(*entityRef, selectionIndex);
 						} else {
 							std::cout << "Invalid entity reference " << entityRef << std::endl;
@@ -176,7 +179,13 @@ void ShipDebugWindow::render() {
 				if (entityRef != nullptr) {
 					
 					StarSystem& system = *entityRef->system;
-					entt::registry& registry = Aurora.settings.render.useShadow ? system.shadow->registry : system.registry;
+					std::optional<ShadowHandle> shadow;
+					
+					if (Aurora.settings.render.useShadow) {
+						shadow.emplace(system);
+					}
+					
+					entt::registry& registry = shadow ? (*shadow)->registry : system.registry;
 					
 					entt::entity entityID = entityRef->entityID;
 					
@@ -20,11 +20,11 @@ StarSystemDebugLayer::StarSystemDebugLayer(AuroraWindow& parentWindow): StarSyst
 StarSystemDebugLayer::~StarSystemDebugLayer() {
 }
 
-void StarSystemDebugLayer::drawSpatialPartitioning() {
+void StarSystemDebugLayer::drawSpatialPartitioning(const ShadowHandle& shadow) {
 	QuadtreePoint* tree;
 	
 	if (Aurora.settings.render.useShadow) {
-		tree = &starSystem->shadow->quadtreeShips;
+		tree = &shadow->quadtreeShips;
 	} else {
 		tree = &starSystem->systems->spatialPartitioningSystem->tree;
 	}
@@ -87,11 +87,11 @@ void StarSystemDebugLayer::drawSpatialPartitioning() {
 	tree->traverse(&traverseData, branch, leaf);
 }
 
-void StarSystemDebugLayer::drawSpatialPartitioningPlanetoids() {
+void StarSystemDebugLayer::drawSpatialPartitioningPlanetoids(const ShadowHandle& shadow) {
 	QuadtreeAABB* tree;
 	
 	if (Aurora.settings.render.useShadow) {
-		tree = &starSystem->shadow->quadtreePlanetoids;
+		tree = &shadow->quadtreePlanetoids;
 	} else {
 		tree = &starSystem->systems->spatialPartitioningPlanetoidsSystem->tree;
 	}
@@ -153,17 +153,46 @@ void StarSystemDebugLayer::drawSpatialPartitioningPlanetoids() {
 	tree->traverse(&traverseData, branch, leaf);
 }
 
+// Speed of each ship next to it, computed when shown instead of written to a component by the simulation every tick
+void StarSystemDebugLayer::drawSpeedLabels(const ShadowHandle& shadow) {
+	entt::registry* registry;
+	
+	if (Aurora.settings.render.useShadow) {
+		registry = &shadow->registry;
+	} else {
+		registry = &starSystem->registry;
+	}
+	
+	auto view = registry->view<TimedMovementComponent, ThrustComponent>();
+	
+	for (entt::entity entity : view) {
+		MovementValues movement = view.get<TimedMovementComponent>(entity).get(Aurora.galaxy->time).value;
+		Vector2i renderPosition = toScreenCoordinates(movement.position);
+		std::string text = fmt::format("{} m/s", (int64_t) movement.velocity.norm() / 100);
+		
+		vk2d::Mesh textMesh = vk2d::GenerateTextMesh(Aurora.assets.font, { renderPosition.x() + 8.0f, (float) renderPosition.y() }, text);
+		window.window->DrawMesh(textMesh);
+	}
+}
+
 void StarSystemDebugLayer::render() {
+	ShadowHandle shadow = starSystem->acquireShadow();
 	
 	if (Aurora.settings.render.debugSpatialPartitioning) {
 		profilerEvents.start("drawSpatialPartitioning");
-		drawSpatialPartitioning();
+		drawSpatialPartitioning(shadow);
 		profilerEvents.end();
 	}
 	
 	if (Aurora.settings.render.debugSpatialPartitioningPlanetoids) {
 		profilerEvents.start("drawSpatialPartitioningPlanetoids");
-		drawSpatialPartitioningPlanetoids();
+		drawSpatialPartitioningPlanetoids(shadow);
+		profilerEvents.end();
+	}
+	
+	if (Aurora.settings.render.debugSpeedLabels) {
+		profilerEvents.start("drawSpeedLabels");
+		drawSpeedLabels(shadow);
 		profilerEvents.end();
 	}
 }
@@ -10,6 +10,7 @@
 #include "StarSystemLayer.hpp"
 
 class StarSystem;
+class ShadowHandle;
 struct CircleComponent;
 class KeyActions_StarSystemLayer;
 
@@ -21,6 +22,7 @@ class StarSystemDebugLayer: public StarSystemLayer {
 		virtual void render() override;
 		
 	private:
-		void drawSpatialPartitioning();
-		void drawSpatialPartitioningPlanetoids();
+		void drawSpatialPartitioning(const ShadowHandle& shadow);
+		void drawSpatialPartitioningPlanetoids(const ShadowHandle& shadow);
+		void drawSpeedLabels(const ShadowHandle& shadow);
 };
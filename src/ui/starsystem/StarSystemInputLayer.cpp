@@ -53,16 +53,16 @@ void StarSystemInputLayer::render() {
 		Vector2l centerOfSelection = { 0,0 };
 		
 		{
-			std::unique_lock<LockableBase(std::mutex)> lock(Aurora.galaxy->shadowLock);
+			ShadowHandle shadow = starSystem->acquireShadow();
 			
 			for (auto it = Player::current->selection.begin(); it != Player::current->selection.end();) {
 				const EntityReference* ref = &*it++;
 				
-				if (!ref->isValid(*starSystem->shadow)) {
+				if (!ref->isValid(*shadow)) {
 					EntityReference cpy = *ref;
 					Player::current->selectionSet.erase(*ref);
 					
-					if (!cpy.resolveReference(*starSystem->shadow)) {
+					if (!cpy.resolveReference(*shadow)) {
 						vectorEraseUnorderedIter(Player::current->selection, it);
 						std::cout << "Removed invalid entity reference " << cpy << std::endl;
 						it--;
@@ -74,7 +74,7 @@ void StarSystemInputLayer::render() {
 				}
 				
 				if (ref->system == starSystem) {
-					TimedMovementComponent movement = starSystem->shadow->registry.get<TimedMovementComponent>(ref->entityID);
+					TimedMovementComponent movement = shadow->registry.get<TimedMovementComponent>(ref->entityID);
 					Vector2l position = movement.get(Aurora.galaxy->time).value.position;
 					centerOfSelection += position;
 				}
@@ -204,7 +204,7 @@ bool StarSystemInputLayer::eventMouseButton(vk2d::MouseButton button, vk2d::Butt
 				commandMenuPotentialStart = false;
 				
 				{
-					std::unique_lock<LockableBase(std::mutex)> lock(Aurora.galaxy->shadowLock);
+					ShadowHandle shadow = starSystem->acquireShadow();
 					
 //					val directSelectionSubscription = system.shadow.world.getAspectSubscriptionManager().get(DIRECT_SELECTION_FAMILY)
 //					val weaponFamilyAspect = system.shadow.world.getAspectSubscriptionManager().get(WEAPON_FAMILY).aspect
@@ -217,17 +217,17 @@ bool StarSystemInputLayer::eventMouseButton(vk2d::MouseButton button, vk2d::Butt
 	
 					std::vector<EntityReference> entitiesUnderMouse {};
 //						val entityIDs = directSelectionSubscription.entities
-					SmallList<entt::entity> entities = SpatialPartitioningSystem::query(starSystem->shadow->quadtreeShips, queryMatrix);
-					SmallList<entt::entity> entitiesPlanetoids = SpatialPartitioningPlanetoidsSystem::query(starSystem->shadow->quadtreePlanetoids, queryMatrix);
+					SmallList<entt::entity> entities = SpatialPartitioningSystem::query(shadow->quadtreeShips, queryMatrix);
+					SmallList<entt::entity> entitiesPlanetoids = SpatialPartitioningPlanetoidsSystem::query(shadow->quadtreePlanetoids, queryMatrix);
 					
 //					std::cout << "entities " << entities << " entitiesPlanetoids " << entitiesPlanetoids << std::endl;
 					entities.append(entitiesPlanetoids);
 					
 					// Exact check first
 					for (entt::entity entity : entities) {
-						if (starSystem->shadow->registry.all_of<TimedMovementComponent, RenderComponent, CircleComponent>(entity)) {
-							TimedMovementComponent& movementComponent = starSystem->shadow->registry.get<TimedMovementComponent>(entity);
-							CircleComponent& circleComponent = starSystem->shadow->registry.get<CircleComponent>(entity);
+						if (shadow->registry.all_of<TimedMovementComponent, RenderComponent, CircleComponent>(entity)) {
+							TimedMovementComponent& movementComponent = shadow->registry.get<TimedMovementComponent>(entity);
+							CircleComponent& circleComponent = shadow->registry.get<CircleComponent>(entity);
 							Vector2l position = movementComponent.get(Aurora.galaxy->time).value.position;
 							float radiusInM;
 
@@ -242,7 +242,7 @@ bool StarSystemInputLayer::eventMouseButton(vk2d::MouseButton button, vk2d::Butt
 							
 //							std::cout << "dist " << vectorDistance(position, mouseInGameCoordinates) << " <= " << radiusInM << " pos " << position << std::endl;
 							if (vectorDistance(position, mouseInGameCoordinates) <= radiusInM) {
-								entitiesUnderMouse.push_back(starSystem->shadow->getEntityReference(entity));
+								entitiesUnderMouse.push_back(shadow->getEntityReference(entity));
 							}
 						}
 					}
@@ -403,18 +403,18 @@ bool StarSystemInputLayer::eventMouseButton(vk2d::MouseButton button, vk2d::Butt
 				std::vector<EntityReference> entitiesInSelection {};
 				
 				{
-					std::unique_lock<LockableBase(std::mutex)> lock(Aurora.galaxy->shadowLock);
+					ShadowHandle shadow = starSystem->acquireShadow();
 					
-					SmallList<entt::entity> entities = SpatialPartitioningSystem::query(starSystem->shadow->quadtreeShips, worldCoordinates);
+					SmallList<entt::entity> entities = SpatialPartitioningSystem::query(shadow->quadtreeShips, worldCoordinates);
 //					std::cout << "worldCoordinates " << worldCoordinates << ", entities " << entities << std::endl;
 					
 					for (entt::entity entity : entities) {
-						if (starSystem->shadow->registry.all_of<TimedMovementComponent, RenderComponent>(entity)) {
-							TimedMovementComponent& movement = starSystem->shadow->registry.get<TimedMovementComponent>(entity);
+						if (shadow->registry.all_of<TimedMovementComponent, RenderComponent>(entity)) {
+							TimedMovementComponent& movement = shadow->registry.get<TimedMovementComponent>(entity);
 							Vector2l position = movement.get(Aurora.galaxy->time).value.position;
 			
 							if (rectangleContains(worldCoordinates, position)) {
-								entitiesInSelection.push_back(starSystem->shadow->getEntityReference(entity)); //TODO avoid duplicates
+								entitiesInSelection.push_back(shadow->getEntityReference(entity)); //TODO avoid duplicates
 							}
 						}
 					}
@@ -444,7 +444,7 @@ bool StarSystemInputLayer::eventMouseButton(vk2d::MouseButton button, vk2d::Butt
 			
 			if (Player::current->selection.size() > 0) {
 				
-				std::unique_lock<LockableBase(std::mutex)> lock(Aurora.galaxy->shadowLock);
+				ShadowHandle shadow = starSystem->acquireShadow();
 				
 //				val movementFamilyAspect = starSystem.shadow.world.getAspectSubscriptionManager().get(MovementSystem.CAN_ACCELERATE_FAMILY).aspect
 //				val directSelectionSubscription = starSystem.shadow.world.getAspectSubscriptionManager().get(DIRECT_SELECTION_FAMILY)
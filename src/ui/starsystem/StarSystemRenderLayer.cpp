@@ -26,12 +26,12 @@ StarSystemRenderLayer::StarSystemRenderLayer(AuroraWindow& parentWindow): StarSy
 StarSystemRenderLayer::~StarSystemRenderLayer() {
 }
 
-void StarSystemRenderLayer::drawEntities() {
+void StarSystemRenderLayer::drawEntities(const ShadowHandle& shadow) {
 	
 	entt::registry* registry;
 	
 	if (Aurora.settings.render.useShadow) {
-		registry = &starSystem->shadow->registry;
+		registry = &shadow->registry;
 	} else {
 		registry = &starSystem->registry;
 	}
@@ -64,7 +64,7 @@ void StarSystemRenderLayer::drawEntities() {
 }
 
 void StarSystemRenderLayer::render() {
-		std::unique_lock<LockableBase(std::mutex)> lock(Aurora.galaxy->shadowLock);
+		ShadowHandle shadow = starSystem->acquireShadow();
 		
 		if (window.profiling) {
 			profilerEvents.clear();
@@ -109,7 +109,7 @@ void StarSystemRenderLayer::render() {
 		PROFILE_End();
 		
 		PROFILE("drawEntities");
-		drawEntities();
+		drawEntities(shadow);
 		PROFILE_End();
 		
 		PROFILE("drawEntityCenters");
@@ -10,6 +10,7 @@
 #include "StarSystemLayer.hpp"
 
 class StarSystem;
+class ShadowHandle;
 
 class StarSystemRenderLayer: public StarSystemLayer {
 	public:
@@ -22,5 +23,5 @@ class StarSystemRenderLayer: public StarSystemLayer {
 		virtual void render() override;
 		
 	private:
-		void drawEntities();
+		void drawEntities(const ShadowHandle& shadow);
 };
@@ -19,8 +19,6 @@ StarSystemStatusLayer::StarSystemStatusLayer(AuroraWindow& parentWindow, StarSys
 : StarSystemLayer(parentWindow),
   inputLayer(inputLayer)
 {
-	lastTickrateUpdate = getMillis();
-	oldGalaxyTime = milliseconds(Aurora.galaxy->time);
 }
 
 StarSystemStatusLayer::~StarSystemStatusLayer() {
@@ -46,14 +44,6 @@ void StarSystemStatusLayer::render() {
 		window.window->DrawMesh(text_mesh);
 	}
 	
-	milliseconds now = getMillis();
-		
-	if (now - lastTickrateUpdate > 1000ms) {
-		lastTickrateUpdate = now;
-		galaxyTickrate = milliseconds(Aurora.galaxy->time) - oldGalaxyTime;
-		oldGalaxyTime = milliseconds(Aurora.galaxy->time);
-	}
-	
 	float y = window.window->GetSize().y - 10;
 	float x = 5;
 	
@@ -74,7 +64,7 @@ void StarSystemStatusLayer::render() {
 	}
 	
 	writeText(window, x, y, fmt::format(" {}", Aurora.galaxy->tickSize));
-	writeText(window, x, y, fmt::format(" {}us {}t/s", (int)(starSystem->updateTimeAverage / 1000), galaxyTickrate.count()));
+	writeText(window, x, y, fmt::format(" {}us {}t/s", (int)(starSystem->updateTimeAverage / 1000), (uint64_t) Aurora.galaxy->achievedSpeed.load(std::memory_order_relaxed)));
 	writeText(window, x, y, fmt::format(", {}st", starSystem->registry.alive()));
 	
 	std::string text = fmt::format("zoom {:02}", inputLayer.zoomLevel);
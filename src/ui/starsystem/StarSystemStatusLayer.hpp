@@ -21,8 +21,4 @@ class StarSystemStatusLayer: public StarSystemLayer {
 		
 	private:
 		StarSystemInputLayer& inputLayer;
-		
-		milliseconds lastTickrateUpdate;
-		milliseconds galaxyTickrate = 0ms;
-		milliseconds oldGalaxyTime;
 };
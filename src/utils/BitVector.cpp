@@ -4,10 +4,116 @@
  *  Created on: Dec 27, 2020
  *      Author: exuvo
  */
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
 
 #include "BitVector.hpp"
 
+// Word kernels, count is in 64 bit words
+
+static inline void orWords(uint64_t* dst, const uint64_t* src, uint32_t count) {
+	uint32_t i = 0;
+#if defined(__AVX512F__)
+	for (; i + 8 <= count; i += 8) {
+		_mm512_storeu_si512(dst + i, _mm512_or_si512(_mm512_loadu_si512(dst + i), _mm512_loadu_si512(src + i)));
+	}
+#elif defined(__AVX2__)
+	for (; i + 4 <= count; i += 4) {
+		__m256i* d = reinterpret_cast<__m256i*>(dst + i);
+		_mm256_storeu_si256(d, _mm256_or_si256(_mm256_loadu_si256(d), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i))));
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] |= src[i];
+	}
+}
+
+static inline void xorWords(uint64_t* dst, const uint64_t* src, uint32_t count) {
+	uint32_t i = 0;
+#if defined(__AVX512F__)
+	for (; i + 8 <= count; i += 8) {
+		_mm512_storeu_si512(dst + i, _mm512_xor_si512(_mm512_loadu_si512(dst + i), _mm512_loadu_si512(src + i)));
+	}
+#elif defined(__AVX2__)
+	for (; i + 4 <= count; i += 4) {
+		__m256i* d = reinterpret_cast<__m256i*>(dst + i);
+		_mm256_storeu_si256(d, _mm256_xor_si256(_mm256_loadu_si256(d), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i))));
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] ^= src[i];
+	}
+}
+
+static inline void andWords(uint64_t* dst, const uint64_t* src, uint32_t count) {
+	uint32_t i = 0;
+#if defined(__AVX512F__)
+	for (; i + 8 <= count; i += 8) {
+		_mm512_storeu_si512(dst + i, _mm512_and_si512(_mm512_loadu_si512(dst + i), _mm512_loadu_si512(src + i)));
+	}
+#elif defined(__AVX2__)
+	for (; i + 4 <= count; i += 4) {
+		__m256i* d = reinterpret_cast<__m256i*>(dst + i);
+		_mm256_storeu_si256(d, _mm256_and_si256(_mm256_loadu_si256(d), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i))));
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] &= src[i];
+	}
+}
+
+static inline void andNotWords(uint64_t* dst, const uint64_t* src, uint32_t count) {
+	uint32_t i = 0;
+#if defined(__AVX512F__)
+	for (; i + 8 <= count; i += 8) {
+		_mm512_storeu_si512(dst + i, _mm512_andnot_si512(_mm512_loadu_si512(src + i), _mm512_loadu_si512(dst + i)));
+	}
+#elif defined(__AVX2__)
+	for (; i + 4 <= count; i += 4) {
+		__m256i* d = reinterpret_cast<__m256i*>(dst + i);
+		_mm256_storeu_si256(d, _mm256_andnot_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)), _mm256_loadu_si256(d)));
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] &= ~src[i];
+	}
+}
+
+static inline uint32_t popcountWords(const uint64_t* src, uint32_t count) {
+	uint32_t i = 0;
+	uint32_t setBits = 0;
+#if defined(__AVX512VPOPCNTDQ__)
+	__m512i sum = _mm512_setzero_si512();
+	for (; i + 8 <= count; i += 8) {
+		sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(_mm512_loadu_si512(src + i)));
+	}
+	setBits = _mm512_reduce_add_epi64(sum);
+#endif
+	// processor specific better implementations can be found at https://github.com/WojciechMula/sse-popcount
+	// for less than 2000 bits __builtin_popcountll looks to be pretty good for most CPUs
+	for (; i < count; i++) {
+		setBits += __builtin_popcountll(src[i]);
+	}
+	return setBits;
+}
+
+// True if all 8 words (one 512 bit block) are zero
+static inline bool emptyBlock(const uint64_t* src) {
+#if defined(__AVX512F__)
+	__m512i block = _mm512_loadu_si512(src);
+	return _mm512_test_epi64_mask(block, block) == 0;
+#elif defined(__AVX2__)
+	__m256i block = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4)));
+	return _mm256_testz_si256(block, block);
+#else
+	return (src[0] | src[1] | src[2] | src[3] | src[4] | src[5] | src[6] | src[7]) == 0;
+#endif
+}
+
 BitVector::_bitReference::operator bool() const {
 	return !!(*ptr & mask);
 }
@@ -15,6 +121,7 @@ BitVector::_bitReference::operator bool() const {
 BitVector::_bitReference& BitVector::_bitReference::operator=(bool value) {
 	if (value) {
 		*ptr |= mask;
+		bv.touch(ptr - bv.data.data());
 	} else {
 		*ptr &= ~mask;
 	}
@@ -44,9 +151,47 @@ uint32_t BitVector::size() {
 }
 
 void BitVector::clear() {
-	for (size_t i=0; i < data.capacity(); i++) {
-		data[i] = 0;
+	if (firstWord < endWord) {
+		memset(data.data() + firstWord, 0, (endWord - firstWord) * sizeof(uint64_t));
 	}
+	
+	firstWord = 0;
+	endWord = 0;
+}
+
+void BitVector::touch(uint32_t word) {
+	if (firstWord == endWord) {
+		firstWord = word;
+		endWord = word + 1;
+	} else {
+		firstWord = std::min(firstWord, word);
+		endWord = std::max(endWord, word + 1);
+	}
+}
+
+uint32_t BitVector::nextWord(uint32_t word) const {
+	word = std::max(word, firstWord);
+	
+	while (word < endWord) {
+		// Skip whole empty 512 bit blocks once aligned
+		if (word % 8 == 0) {
+			while (word + 8 <= endWord && emptyBlock(data.data() + word)) {
+				word += 8;
+			}
+			
+			if (word >= endWord) {
+				break;
+			}
+		}
+		
+		if (data[word] != 0) {
+			return word;
+		}
+		
+		word++;
+	}
+	
+	return NO_WORD;
 }
 
 bool BitVector::operator [](const uint32_t index) const {
@@ -56,16 +201,24 @@ bool BitVector::operator [](const uint32_t index) const {
 
 BitVector::_bitReference BitVector::operator [](const uint32_t index) {
 	assert(index >> 6 < data.capacity());
-	return _bitReference(&data[index >> 6], BV(index));
+	return _bitReference(*this, &data[index >> 6], BV(index));
 }
 
 uint64_t& BitVector::operator ()(const uint32_t index) {
 	assert(index < data.capacity());
+	touch(index);
 	return data[index];
 }
 
 void BitVector::operator =(const BitVector& bv) {
-	data = bv.data;
+	reserve(bv.data.size() * 64);
+	clear();
+	
+	if (bv.firstWord < bv.endWord) {
+		memcpy(data.data() + bv.firstWord, bv.data.data() + bv.firstWord, (bv.endWord - bv.firstWord) * sizeof(uint64_t));
+		firstWord = bv.firstWord;
+		endWord = bv.endWord;
+	}
 }
 
 bool BitVector::operator ==(const BitVector& bv) {
@@ -73,55 +226,68 @@ bool BitVector::operator ==(const BitVector& bv) {
 		return false;
 	}
 	
-	size_t size = data.capacity();
-	for (size_t i=0; i < size; i++) {
-		if (data[i] != bv.data[i]) {
-			return false;
-		}
-	}
+	uint32_t start = std::min(firstWord, bv.firstWord);
+	uint32_t end = std::max(endWord, bv.endWord);
 	
-	return true;
+	return start >= end || memcmp(data.data() + start, bv.data.data() + start, (end - start) * sizeof(uint64_t)) == 0;
 }
 
 void BitVector::operator &=(const BitVector& bv) {
 	assert(data.capacity() == bv.data.capacity());
 	
-	size_t size = data.capacity();
-	for (size_t i=0; i < size; i++) {
-		data[i] &= bv.data[i];
+	uint32_t start = std::max(firstWord, bv.firstWord);
+	uint32_t end = std::min(endWord, bv.endWord);
+	
+	if (start >= end) {
+		clear();
+		return;
 	}
+	
+	// Everything outside the other range is cleared
+	memset(data.data() + firstWord, 0, (start - firstWord) * sizeof(uint64_t));
+	memset(data.data() + end, 0, (endWord - end) * sizeof(uint64_t));
+	
+	andWords(data.data() + start, bv.data.data() + start, end - start);
+	firstWord = start;
+	endWord = end;
 }
 
 void BitVector::operator |=(const BitVector& bv) {
 	assert(data.capacity() >= bv.data.capacity());
 	
-	size_t size = bv.data.capacity();
-	for (size_t i=0; i < size; i++) {
-		data[i] |= bv.data[i];
+	if (bv.firstWord < bv.endWord) {
+		orWords(data.data() + bv.firstWord, bv.data.data() + bv.firstWord, bv.endWord - bv.firstWord);
+		touch(bv.firstWord);
+		touch(bv.endWord - 1);
 	}
 }
 
 void BitVector::operator ^=(const BitVector& bv) {
 	assert(data.capacity() >= bv.data.capacity());
 	
-	size_t size = bv.data.capacity();
-	for (size_t i=0; i < size; i++) {
-		data[i] ^= bv.data[i];
+	if (bv.firstWord < bv.endWord) {
+		xorWords(data.data() + bv.firstWord, bv.data.data() + bv.firstWord, bv.endWord - bv.firstWord);
+		touch(bv.firstWord);
+		touch(bv.endWord - 1);
 	}
 }
 
 void BitVector::operator %=(const BitVector& bv) {
 	assert(data.capacity() >= bv.data.capacity());
 	
-	size_t size = bv.data.capacity();
-	for (size_t i=0; i < size; i++) {
-		data[i] &= ~bv.data[i];
+	uint32_t start = std::max(firstWord, bv.firstWord);
+	uint32_t end = std::min(endWord, bv.endWord);
+	
+	if (start < end) {
+		andNotWords(data.data() + start, bv.data.data() + start, end - start);
 	}
 }
 
 bool BitVector::intersects(const BitVector& bv) {
-	size_t size = data.capacity();
-	for (size_t i=0; i < size; i++) {
+	uint32_t start = std::max(firstWord, bv.firstWord);
+	uint32_t end = std::min(endWord, bv.endWord);
+	
+	for (uint32_t i = start; i < end; i++) {
 		if (data[i] & bv.data[i]) {
 			return true;
 		}
@@ -130,28 +296,131 @@ bool BitVector::intersects(const BitVector& bv) {
 }
 
 bool BitVector::containsAll(const BitVector& bv) {
-	size_t size = data.capacity();
-	for (size_t i=0; i < size; i++) {
-		if (data[i] != (data[i] & bv.data[i])) {
+	for (uint32_t i = firstWord; i < endWord; i++) {
+		uint64_t other = i < bv.data.size() ? bv.data[i] : 0;
+		
+		if (data[i] != (data[i] & other)) {
 			return false;
 		}
 	}
 	return true;
 }
 
-// processor specific better implementations can be found at https://github.com/WojciechMula/sse-popcount
-// for less than 2000 bits __builtin_popcountll looks to be pretty good for most CPUs
 uint32_t BitVector::cardinality() {
-	uint32_t setBits = 0;
+	return firstWord < endWord ? popcountWords(data.data() + firstWord, endWord - firstWord) : 0;
+}
+
+HierarchicalBitVector::_bitReference::operator bool() const {
+	return const_cast<const HierarchicalBitVector&>(bv)[index];
+}
+
+HierarchicalBitVector::_bitReference& HierarchicalBitVector::_bitReference::operator=(bool value) {
+	uint32_t word = index >> 6;
 	
-	size_t size = data.capacity();
-	for (size_t i=0; i < size; i++) {
-		setBits += __builtin_popcountll(data[i]);
+	if (value) {
+		bv.words[word] |= 1ull << (index & 0x3F);
+		bv.summary[word] = true;
+	} else {
+		bv.words[word] &= ~(1ull << (index & 0x3F));
 	}
+	return *this;
+}
+
+HierarchicalBitVector::_bitReference& HierarchicalBitVector::_bitReference::operator=(const _bitReference& value) {
+	return *this = bool(value);
+}
+
+bool HierarchicalBitVector::_bitReference::operator==(const _bitReference& value) const {
+	return bool(*this) == bool(value);
+}
+
+void HierarchicalBitVector::reserve(uint32_t capacity) {
+	uint32_t longs = (63 + capacity) / 64;
 	
-	return setBits;
+	if (longs > words.size()) {
+		words.resize(longs);
+		summary.reserve(longs + 1); // BitVector never iterates its last bit
+	}
+}
+
+uint32_t HierarchicalBitVector::size() {
+	return words.size() * 64;
+}
+
+void HierarchicalBitVector::clear() {
+	eachWord(summary, [&](uint32_t word) {
+		words[word] = 0;
+	});
+	
+	summary.clear();
+}
+
+bool HierarchicalBitVector::operator [](const uint32_t index) const {
+	assert(index >> 6 < words.size());
+	return words[index >> 6] & (1ull << (index & 0x3F));
+}
+
+HierarchicalBitVector::_bitReference HierarchicalBitVector::operator [](const uint32_t index) {
+	assert(index >> 6 < words.size());
+	return _bitReference(*this, index);
+}
+
+void HierarchicalBitVector::operator =(const HierarchicalBitVector& bv) {
+	clear();
+	reserve(bv.words.size() * 64);
+	
+	eachWord(bv.summary, [&](uint32_t word) {
+		words[word] = bv.words[word];
+	});
+	
+	summary = bv.summary;
+}
+
+void HierarchicalBitVector::operator &=(const HierarchicalBitVector& bv) {
+	eachWord(summary, [&](uint32_t word) {
+		if (word < bv.words.size()) {
+			words[word] &= bv.words[word];
+		} else {
+			words[word] = 0;
+		}
+		
+		if (words[word] == 0) {
+			summary[word] = false;
+		}
+	});
 }
 
+void HierarchicalBitVector::operator |=(const HierarchicalBitVector& bv) {
+	reserve(bv.words.size() * 64);
+	
+	eachWord(bv.summary, [&](uint32_t word) {
+		words[word] |= bv.words[word];
+	});
+	
+	summary |= bv.summary;
+}
+
+void HierarchicalBitVector::operator %=(const HierarchicalBitVector& bv) {
+	eachWord(bv.summary, [&](uint32_t word) {
+		if (word < words.size() && summary[word]) {
+			words[word] &= ~bv.words[word];
+			
+			if (words[word] == 0) {
+				summary[word] = false;
+			}
+		}
+	});
+}
+
+uint32_t HierarchicalBitVector::cardinality() {
+	uint32_t setBits = 0;
+	
+	eachWord(summary, [&](uint32_t word) {
+		setBits += __builtin_popcountll(words[word]);
+	});
+	
+	return setBits;
+}
 
 BitVector32::_bitReference::operator bool() const {
 	return !!(*ptr & mask);
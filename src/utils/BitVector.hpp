@@ -11,6 +11,8 @@
 #include <stdint.h>
 #include <vector>
 
+// Words outside [firstWord, endWord) are always zero so clears, set operations and iteration only touch the populated range.
+// The set operations use AVX-512 or AVX2 when compiled for it.
 class BitVector {
 	public:
 		BitVector() = default;
@@ -23,19 +25,21 @@ class BitVector {
 		
 		class _bitReference {
 			public:
-				_bitReference(uint64_t* ptr, uint64_t mask): ptr(ptr), mask(mask) {};
+				_bitReference(BitVector& bv, uint64_t* ptr, uint64_t mask): bv(bv), ptr(ptr), mask(mask) {};
 				_bitReference(const _bitReference&) = default;
 				operator bool() const;
 				_bitReference& operator =(bool value);
 				_bitReference& operator =(const _bitReference& value);
 				bool operator ==(const _bitReference& value) const;
 			private:
+				BitVector& bv;
 				uint64_t* ptr;
 				uint64_t mask;
 		};
 		
 		bool operator [](const uint32_t index) const;
 		_bitReference operator [](const uint32_t index);
+		// Raw word access, the word is assumed to be written to
 		uint64_t& operator ()(const uint32_t index);
 		
 		void operator =(const BitVector& bv);
@@ -58,7 +62,7 @@ class BitVector {
 		
 		class iterator {
 			public:
-				iterator(BitVector& bv, uint32_t idx): bv(bv), longIdx(idx >> 6), bitIdx(idx), val(bv.data[longIdx] >> (idx % 64)) {}
+				iterator(BitVector& bv, uint32_t idx): bv(bv), longIdx(idx >> 6), bitIdx(idx), val(longIdx < bv.data.size() ? bv.data[longIdx] >> (idx % 64) : 0) {}
 				
 				// iterator traits
 				using difference_type = uint32_t;
@@ -76,18 +80,17 @@ class BitVector {
 					bitIdx++;
 					
 					if (val == 0) {
-						while (val == 0 && longIdx < bv.data.size() - 1) {
-							val = bv.data[++longIdx];
-						}
-						
-						bitIdx = longIdx * 64;
+						longIdx = bv.nextWord(longIdx + 1);
 						
-						if (val == 0) {
-							bitIdx += 63; // end
+						if (longIdx == NO_WORD) {
+							longIdx = (bv.size() - 1) >> 6;
+							bitIdx = bv.size() - 1; // end
+							
 						} else {
+							val = bv.data[longIdx];
 							uint32_t firstBit = __builtin_ffsll(val) - 1;
 							val >>= firstBit;
-							bitIdx += firstBit;
+							bitIdx = longIdx * 64 + firstBit;
 						}
 						
 					} else if (!(val & 1)) {
@@ -126,29 +129,148 @@ class BitVector {
 		};
 		
 		iterator begin() {
-			uint32_t longIdx = 0;
-			
-			while (data[longIdx] == 0 && longIdx < data.size() - 1) {
-				longIdx++;
-			}
+			uint32_t longIdx = nextWord(firstWord);
 			
-			uint64_t val = data[longIdx];
-			
-			if (val == 0) {
+			if (longIdx == NO_WORD) {
 				return end();
 			}
 			
-			uint32_t bitIdx = longIdx * 64 + __builtin_ffsll(val) - 1;
+			uint32_t bitIdx = longIdx * 64 + __builtin_ffsll(data[longIdx]) - 1;
 			
 			return iterator(*this, bitIdx);
 		}
 		iterator end() { return iterator(*this, size() - 1); }
 		
 	private:
+		friend class HierarchicalBitVector;
+		static constexpr uint32_t NO_WORD = UINT32_MAX;
+		
 		std::vector<uint64_t> data;
+		uint32_t firstWord = 0;
+		uint32_t endWord = 0;
+		
+		void touch(uint32_t word);
+		// Index of the first non-zero word at or after word, or NO_WORD
+		uint32_t nextWord(uint32_t word) const;
+		
 		static constexpr uint64_t BV(uint8_t index) {
-			return 1 << (index & 0x3F);
+			return 1ull << (index & 0x3F);
+		};
+};
+
+// Two level bit set for sparse sets of large indices like entity ids.
+// The summary has one bit per word of bits that may be non-zero so iterating, clearing and set operations only visit
+//  populated words instead of every word up to the largest index.
+class HierarchicalBitVector {
+	public:
+		HierarchicalBitVector() = default;
+		HierarchicalBitVector(const HierarchicalBitVector&) = default;
+		HierarchicalBitVector(HierarchicalBitVector&&) = default;
+		
+		void reserve(uint32_t capacity);
+		uint32_t size();
+		void clear();
+		
+		class _bitReference {
+			public:
+				_bitReference(HierarchicalBitVector& bv, uint32_t index): bv(bv), index(index) {};
+				_bitReference(const _bitReference&) = default;
+				operator bool() const;
+				_bitReference& operator =(bool value);
+				_bitReference& operator =(const _bitReference& value);
+				bool operator ==(const _bitReference& value) const;
+			private:
+				HierarchicalBitVector& bv;
+				uint32_t index;
 		};
+		
+		bool operator [](const uint32_t index) const;
+		_bitReference operator [](const uint32_t index);
+		
+		void operator =(const HierarchicalBitVector& bv);
+		
+		void operator &=(const HierarchicalBitVector& bv);
+		void operator |=(const HierarchicalBitVector& bv);
+		// And not
+		void operator %=(const HierarchicalBitVector& bv);
+		
+		uint32_t cardinality();
+		
+		class iterator {
+			public:
+				static constexpr uint32_t END = UINT32_MAX;
+				
+				iterator(HierarchicalBitVector& bv, bool end): bv(bv), bitIdx(END) {
+					if (!end) {
+						next();
+					}
+				}
+				
+				// iterator traits
+				using difference_type = uint32_t;
+				using value_type = _bitReference;
+				using iterator_category = std::forward_iterator_tag;
+				
+				inline uint32_t operator*() const { return bitIdx; }
+				
+				iterator& operator++() {
+					val &= val - 1;
+					next();
+					return *this;
+				}
+				
+				inline bool operator==(const iterator& rhs) const {return bitIdx == rhs.bitIdx;}
+				inline bool operator!=(const iterator& rhs) const {return bitIdx != rhs.bitIdx;}
+				
+			private:
+				HierarchicalBitVector& bv;
+				uint32_t summaryWord = BitVector::NO_WORD;
+				uint64_t summaryVal = 0;
+				uint32_t word = 0;
+				uint64_t val = 0;
+				uint32_t bitIdx;
+				
+				// Moves to the lowest bit of val, loading the next populated word from the summary when val is empty
+				void next() {
+					while (val == 0) {
+						while (summaryVal == 0) {
+							summaryWord = bv.summary.nextWord(summaryWord + 1);
+							
+							if (summaryWord == BitVector::NO_WORD) {
+								bitIdx = END;
+								return;
+							}
+							
+							summaryVal = bv.summary.data[summaryWord];
+						}
+						
+						word = summaryWord * 64 + __builtin_ctzll(summaryVal);
+						summaryVal &= summaryVal - 1;
+						val = bv.words[word];
+					}
+					
+					bitIdx = word * 64 + __builtin_ctzll(val);
+				}
+		};
+		
+		iterator begin() { return iterator(*this, false); }
+		iterator end() { return iterator(*this, true); }
+		
+	private:
+		std::vector<uint64_t> words;
+		BitVector summary; // Bit n is set if words[n] may be non-zero
+		
+		template<typename Function>
+		static void eachWord(const BitVector& summary, Function function) {
+			for (uint32_t w = summary.nextWord(0); w != BitVector::NO_WORD; w = summary.nextWord(w + 1)) {
+				uint64_t val = summary.data[w];
+				
+				while (val) {
+					function(w * 64 + __builtin_ctzll(val));
+					val &= val - 1;
+				}
+			}
+		}
 };
 
 class BitVector32 {
@@ -329,7 +451,7 @@ class BitVector64 {
 	private:
 		uint64_t data = 0;
 		static constexpr uint64_t BV(uint8_t index) {
-			return 1 << (index & 0x3F);
+			return 1ull << (index & 0x3F);
 		};
 };
 
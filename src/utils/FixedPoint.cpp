@@ -0,0 +1,136 @@
+/*
+ * FixedPoint.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: exuvo
+ */
+
+#include <cmath>
+#include <limits>
+
+#include "FixedPoint.hpp"
+
+namespace FixedPoint {
+	
+	// atan(2^-i) as Angle, computed offline with 80 digit arithmetic so no floating point is involved
+	static const Angle ATAN_TABLE[] = {
+		0x2000000000000000, 0x12e4051d9df30866, 0x9fb385b5ee39e8e, 0x51111d41ddd9a1b, 0x28b0d430e589aed, 0x145d7e159046278, 0xa2f61e5c28262a, 0x517c5511d442af,
+		0x28be5346d0c337, 0x145f2ebb30ab38, 0xa2f980091ba7b, 0x517cc14a80cb7, 0x28be60cdfec62, 0x145f306c172f2, 0xa2f9836ae911, 0x517cc1b6ba7c,
+		0x28be60db85fc, 0x145f306dc816, 0xa2f9836e4ae, 0x517cc1b726b, 0x28be60db938, 0x145f306dc9c, 0xa2f9836e4e, 0x517cc1b727,
+		0x28be60db94, 0x145f306dca, 0xa2f9836e5, 0x517cc1b72, 0x28be60db9, 0x145f306dd, 0xa2f9836e, 0x517cc1b7,
+		0x28be60dc, 0x145f306e, 0xa2f9837, 0x517cc1b, 0x28be60e, 0x145f307, 0xa2f983, 0x517cc2,
+		0x28be61, 0x145f30, 0xa2f98, 0x517cc, 0x28be6, 0x145f3, 0xa2fa, 0x517d,
+		0x28be, 0x145f, 0xa30, 0x518, 0x28c, 0x146, 0xa3, 0x51,
+		0x29, 0x14, 0xa, 0x5, 0x3, 0x1, 0x1,
+	};
+	
+	static const int ITERATIONS = sizeof(ATAN_TABLE) / sizeof(ATAN_TABLE[0]);
+	
+	static const int64_t CORDIC_GAIN_INVERSE = 2800459870029452954LL; // Product of 1 / sqrt(1 + 2^-2i) in Q62
+	
+	uint64_t sqrt(unsigned __int128 value) {
+		// The floating point estimate only needs to be close, the corrections make the result exact
+		double estimate = std::sqrt((double) value);
+		uint64_t root = estimate >= 0x1p64 ? std::numeric_limits<uint64_t>::max() : (uint64_t) estimate;
+		
+		while ((unsigned __int128) root * root > value) {
+			root--;
+		}
+		
+		while (root < std::numeric_limits<uint64_t>::max() && (unsigned __int128) (root + 1) * (root + 1) <= value) {
+			root++;
+		}
+		
+		return root;
+	}
+	
+	void sinCos(Angle angle, int64_t& sin, int64_t& cos) {
+		// CORDIC converges for ±90°, rotate the other half of the circle by 180° and flip the result
+		bool flip = angle > QUARTER_TURN && angle <= 3 * QUARTER_TURN;
+		
+		if (flip) {
+			angle -= HALF_TURN;
+		}
+		
+		int64_t x = CORDIC_GAIN_INVERSE;
+		int64_t y = 0;
+		int64_t z = (int64_t) angle;
+		
+		for (int i = 0; i < ITERATIONS; i++) {
+			int64_t dx = y >> i;
+			int64_t dy = x >> i;
+			
+			if (z >= 0) {
+				x -= dx;
+				y += dy;
+				z -= (int64_t) ATAN_TABLE[i];
+				
+			} else {
+				x += dx;
+				y -= dy;
+				z += (int64_t) ATAN_TABLE[i];
+			}
+		}
+		
+		sin = flip ? -y : y;
+		cos = flip ? -x : x;
+	}
+	
+	Angle atan2(int64_t y, int64_t x) {
+		if (x == 0 && y == 0) {
+			return 0;
+		}
+		
+		// Scale to the same range as CORDIC_GAIN_INVERSE so the gain of up to 1.65 * sqrt(2) can not overflow
+		__int128_t x2 = x;
+		__int128_t y2 = y;
+		
+		while (std::max(x2 < 0 ? -x2 : x2, y2 < 0 ? -y2 : y2) >= ((__int128_t) 1 << 61)) {
+			x2 /= 2;
+			y2 /= 2;
+		}
+		
+		while (std::max(x2 < 0 ? -x2 : x2, y2 < 0 ? -y2 : y2) < ((__int128_t) 1 << 60)) {
+			x2 *= 2;
+			y2 *= 2;
+		}
+		
+		int64_t vx = x2;
+		int64_t vy = y2;
+		Angle z = 0;
+		
+		if (vx < 0) {
+			vx = -vx;
+			vy = -vy;
+			z = HALF_TURN;
+		}
+		
+		for (int i = 0; i < ITERATIONS; i++) {
+			int64_t dx = vy >> i;
+			int64_t dy = vx >> i;
+			
+			if (vy > 0) {
+				vx += dx;
+				vy -= dy;
+				z += ATAN_TABLE[i];
+				
+			} else {
+				vx -= dx;
+				vy += dy;
+				z -= ATAN_TABLE[i];
+			}
+		}
+		
+		return z;
+	}
+	
+	Vector2l vectorRotate(const Vector2l& a, Angle angle) {
+		int64_t sin, cos;
+		sinCos(angle, sin, cos);
+		
+		__int128_t x = a.x();
+		__int128_t y = a.y();
+		
+		return Vector2l { (x * cos - y * sin) / ONE, (x * sin + y * cos) / ONE };
+	}
+}
@@ -0,0 +1,64 @@
+/*
+ * FixedPoint.hpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: exuvo
+ */
+
+#ifndef SRC_UTILS_FIXEDPOINT_HPP_
+#define SRC_UTILS_FIXEDPOINT_HPP_
+
+#include <stdint.h>
+
+#include "Math.hpp"
+
+// Integer only math for the deterministic simulation mode. Results do not depend on compiler flags like -ffast-math,
+//  the floating point unit or the order threads run in, so simulations stay bit identical between builds and machines.
+namespace FixedPoint {
+	// Fractions like sine and cosine are Q62, ONE represents 1.0
+	const int FRACTION_BITS = 62;
+	const int64_t ONE = 1LL << FRACTION_BITS;
+	
+	// Angles are binary angles where the full uint64_t range is one turn, so they wrap around for free
+	typedef uint64_t Angle;
+	const Angle QUARTER_TURN = 1ULL << 62;
+	const Angle HALF_TURN = 1ULL << 63;
+	
+	const int64_t INVERSE_TWO_PI = 2935890503282001226LL; // 1 / 2π in Q64, converts fractions of a radian to Angle
+	const int64_t TWO_PI = 7244019458077122842LL; // 2π in Q60
+	const int TWO_PI_FRACTION_BITS = 60;
+	
+	// Exact floor(sqrt(value))
+	uint64_t sqrt(unsigned __int128 value);
+	
+	inline int64_t norm(int64_t x, int64_t y) {
+		return sqrt((unsigned __int128) ((__int128_t) x * x + (__int128_t) y * y));
+	}
+	
+	inline int64_t norm(const Vector2l& a) {
+		return norm(a.x(), a.y());
+	}
+	
+	// Multiplies by a Q62 fraction, truncating towards zero like the integer vector math it replaces
+	inline int64_t multiply(int64_t value, int64_t fraction) {
+		return ((__int128_t) value * fraction) / ONE;
+	}
+	
+	constexpr Angle fromDegrees(int64_t degrees) {
+		return (Angle) (((__int128_t) degrees << 64) / 360);
+	}
+	
+	// Q62 sine and cosine using CORDIC
+	void sinCos(Angle angle, int64_t& sin, int64_t& cos);
+	
+	// Angle of the vector towards the positive y-axis like std::atan2(y, x), 0 for the zero vector
+	Angle atan2(int64_t y, int64_t x);
+	
+	inline Angle vectorAngle(const Vector2l& a) {
+		return atan2(a.y(), a.x());
+	}
+	
+	__attribute__((warn_unused_result)) Vector2l vectorRotate(const Vector2l& a, Angle angle);
+}
+
+#endif /* SRC_UTILS_FIXEDPOINT_HPP_ */
@@ -0,0 +1,194 @@
+/*
+ * JobSystem.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: exuvo
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <thread>
+
+#include "utils/JobSystem.hpp"
+#include "utils/Utils.hpp"
+
+thread_local uint32_t JobSystem::currentWorker = JobSystem::NO_WORKER;
+
+JobSystem::~JobSystem() {
+	for (Queue* queue : queues) {
+		delete queue;
+	}
+}
+
+void JobSystem::init(uint32_t workers) {
+	assert(queues.empty()); // Queues can not be replaced while workers may be stealing from them
+	queues.reserve(workers);
+	
+	for (uint32_t i = 0; i < workers; i++) {
+		queues.push_back(new Queue());
+	}
+}
+
+void JobSystem::setWorker(uint32_t workerIndex) {
+	currentWorker = workerIndex;
+}
+
+uint32_t JobSystem::getWorker() {
+	return currentWorker;
+}
+
+bool JobSystem::Queue::pop(Job& job) {
+	std::lock_guard<std::mutex> lock(mutex);
+	
+	if (jobs.empty()) {
+		return false;
+	}
+	
+	job = jobs.back();
+	jobs.pop_back();
+	return true;
+}
+
+bool JobSystem::Queue::steal(Job& job) {
+	std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+	
+	if (!lock.owns_lock()) {
+		return false;
+	}
+	
+	auto it = std::find_if(jobs.begin(), jobs.end(), [](const Job& job) { return !job.pinned; });
+	
+	if (it == jobs.end()) {
+		return false;
+	}
+	
+	job = *it;
+	jobs.erase(it);
+	return true;
+}
+
+// Newest job of batch from anywhere in the queue, batches are never pinned
+bool JobSystem::Queue::take(Job& job, const std::atomic<uint32_t>* batch) {
+	std::lock_guard<std::mutex> lock(mutex);
+	
+	auto it = std::find_if(jobs.rbegin(), jobs.rend(), [batch](const Job& job) { return job.remaining == batch; });
+	
+	if (it == jobs.rend()) {
+		return false;
+	}
+	
+	job = *it;
+	jobs.erase(std::next(it).base());
+	return true;
+}
+
+void JobSystem::push(const Job& job) {
+	uint32_t workerIndex = currentWorker;
+	
+	if (workerIndex == NO_WORKER || workerIndex >= queues.size()) {
+		workerIndex = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+	}
+	
+	push(workerIndex, job);
+}
+
+void JobSystem::push(uint32_t workerIndex, const Job& job) {
+	Queue& queue = *queues[workerIndex];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(job);
+	}
+	
+	generation.fetch_add(1, std::memory_order_release);
+	generation.notify_all(); // No syscall unless someone is parked
+}
+
+bool JobSystem::runOne() {
+	Job job;
+	uint32_t size = queues.size();
+	uint32_t self = currentWorker;
+	
+	if (self < size && queues[self]->pop(job)) {
+		job.run();
+		return true;
+	}
+	
+	// Start stealing from our neighbour so that thieves spread out over the queues
+	uint32_t start = self < size ? self + 1 : nextQueue.load(std::memory_order_relaxed);
+	
+	for (uint32_t i = 0; i < size; i++) {
+		uint32_t victim = (start + i) % size;
+		
+		if (victim != self && queues[victim]->steal(job)) {
+			stolenCount.fetch_add(1, std::memory_order_relaxed);
+			job.run();
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+bool JobSystem::runOne(const std::atomic<uint32_t>& batch) {
+	Job job;
+	uint32_t size = queues.size();
+	uint32_t self = currentWorker;
+	uint32_t start = self < size ? self : 0;
+	
+	for (uint32_t i = 0; i < size; i++) {
+		uint32_t queue = (start + i) % size;
+		
+		if (queues[queue]->take(job, &batch)) {
+			if (queue != self) {
+				stolenCount.fetch_add(1, std::memory_order_relaxed);
+			}
+			
+			job.run();
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+void JobSystem::waitForJobs(uint32_t lastGeneration) {
+	const nanoseconds spinUntil = getNanos() + IDLE_SPIN;
+	
+	while (generation.load(std::memory_order_acquire) == lastGeneration) {
+		if (getNanos() < spinUntil) {
+			cpuRelax();
+		} else {
+			generation.wait(lastGeneration, std::memory_order_acquire);
+		}
+	}
+}
+
+void JobSystem::wakeAll() {
+	generation.fetch_add(1, std::memory_order_release);
+	generation.notify_all();
+}
+
+void JobSystem::help(std::atomic<uint32_t>& remaining) {
+	while (remaining.load(std::memory_order_acquire) > 0) {
+		if (!runOne(remaining)) { // The rest are already running on other workers
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::parallelFor(Job::function_type* function, void* data, uint32_t count) {
+	if (count == 0) {
+		return;
+	}
+	
+	std::atomic<uint32_t> remaining = count - 1;
+	
+	for (uint32_t i = 1; i < count; i++) {
+		push(Job { function, data, i, &remaining });
+	}
+	
+	// Do the first chunk ourselves while others steal the rest
+	function(data, 0);
+	
+	help(remaining);
+}
@@ -0,0 +1,102 @@
+/*
+ * JobSystem.hpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: exuvo
+ */
+
+#ifndef SRC_UTILS_JOBSYSTEM_HPP_
+#define SRC_UTILS_JOBSYSTEM_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+using namespace std::chrono;
+
+struct Job {
+		using function_type = void (void* data, uint32_t index);
+
+		function_type* function = nullptr;
+		void* data = nullptr;
+		uint32_t index = 0;
+		std::atomic<uint32_t>* remaining = nullptr; // Decremented when the job has finished, may be null
+		bool pinned = false; // Only run by the worker whose queue it was pushed to, never stolen
+
+		void run() const {
+			function(data, index);
+
+			if (remaining) {
+				remaining->fetch_sub(1, std::memory_order_release);
+			}
+		}
+};
+
+// Work stealing job pool. Each worker owns one queue that it pushes to and pops from the back of (LIFO, cache warm),
+//  idle workers steal from the front of other workers queues (FIFO, oldest and usually largest jobs) skipping pinned jobs.
+// Threads are owned by the caller, they identify themselves with setWorker and then call runOne/help.
+class JobSystem {
+	public:
+		static constexpr uint32_t NO_WORKER = std::numeric_limits<uint32_t>::max();
+		static constexpr nanoseconds IDLE_SPIN = 20us;
+
+		JobSystem() = default;
+		JobSystem(const JobSystem&) = delete;
+		~JobSystem();
+
+		// Only once, before any worker runs
+		void init(uint32_t workers);
+		uint32_t workers() const { return queues.size(); }
+
+		// Marks the calling thread as owner of queue workerIndex
+		static void setWorker(uint32_t workerIndex);
+		static uint32_t getWorker();
+
+		// Pushes to the calling workers queue, or round robin if called from a non worker thread
+		void push(const Job& job);
+		void push(uint32_t workerIndex, const Job& job);
+
+		// Runs one job from our own queue or stolen from another, returns false if all queues were empty
+		bool runOne();
+		// Runs one job that counts down batch from any queue, returns false if none of them are queued anymore
+		bool runOne(const std::atomic<uint32_t>& batch);
+		
+		// Bumped on every push. Read it before runOne and pass it to waitForJobs if runOne found nothing,
+		//  that way a push in between is never missed.
+		uint32_t getGeneration() const { return generation.load(std::memory_order_acquire); }
+		// Spins for a short while and then parks until something is pushed or wakeAll is called
+		void waitForJobs(uint32_t lastGeneration);
+		void wakeAll();
+
+		// Runs count jobs of function on data with index 0 to count-1 and returns when all have completed.
+		//  The calling thread participates and helps with the rest of them while waiting.
+		void parallelFor(Job::function_type* function, void* data, uint32_t count);
+
+		// Runs queued jobs of the batch counted by remaining until it reaches 0. Never runs unrelated jobs, those could be
+		//  whole star system updates that would then run nested inside the job waiting here.
+		void help(std::atomic<uint32_t>& remaining);
+
+		uint64_t getStolenCount() const { return stolenCount.load(std::memory_order_relaxed); }
+
+	private:
+		struct alignas(64) Queue {
+				std::mutex mutex;
+				std::deque<Job> jobs;
+
+				bool pop(Job& job);
+				bool steal(Job& job);
+				bool take(Job& job, const std::atomic<uint32_t>* batch);
+		};
+
+		static thread_local uint32_t currentWorker;
+
+		std::vector<Queue*> queues;
+		std::atomic<uint32_t> nextQueue = 0;
+		alignas(64) std::atomic<uint32_t> generation = 0;
+		std::atomic<uint64_t> stolenCount = 0;
+};
+
+#endif /* SRC_UTILS_JOBSYSTEM_HPP_ */
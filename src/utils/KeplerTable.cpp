@@ -0,0 +1,98 @@
+/*
+ * KeplerTable.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: exuvo
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#include "KeplerTable.hpp"
+
+KeplerTable::KeplerTable(double eccentricity)
+: eccentricity(eccentricity)
+{
+	uint32_t samples = 64;
+	
+	while (true) {
+		build(samples);
+		
+		if (samples >= MAX_SAMPLES) {
+			break;
+		}
+		
+		// Interpolation error is largest between samples
+		double maxError = 0;
+		
+		for (uint32_t i = 0; i < samples; i++) {
+			double meanAnomaly = (i + 0.5) * step;
+			maxError = std::max(maxError, std::abs(interpolate(meanAnomaly) - solve(eccentricity, meanAnomaly)));
+		}
+		
+		if (maxError <= TOLERANCE) {
+			break;
+		}
+		
+		samples *= 2;
+	}
+}
+
+void KeplerTable::build(uint32_t samples) {
+	step = std::numbers::pi / samples;
+	inverseStep = samples / std::numbers::pi;
+	anomalies.resize(samples + 1);
+	derivatives.resize(samples + 1);
+	
+	for (uint32_t i = 0; i <= samples; i++) {
+		double E = solve(eccentricity, i * step);
+		anomalies[i] = E;
+		derivatives[i] = step / (1.0 - eccentricity * std::cos(E));
+	}
+}
+
+double KeplerTable::interpolate(double meanAnomaly) const {
+	double x = meanAnomaly * inverseStep;
+	uint32_t i = std::min<uint32_t>(x, anomalies.size() - 2);
+	double t = x - i;
+	double t2 = t * t;
+	double t3 = t2 * t;
+	
+	return (2 * t3 - 3 * t2 + 1) * anomalies[i] + (t3 - 2 * t2 + t) * derivatives[i]
+	     + (-2 * t3 + 3 * t2) * anomalies[i + 1] + (t3 - t2) * derivatives[i + 1];
+}
+
+double KeplerTable::eccentricAnomaly(double meanAnomaly) const {
+	// E(-M) = -E(M)
+	double M = std::remainder(meanAnomaly, 2 * std::numbers::pi);
+	
+	if (M < 0) {
+		return -interpolate(-M);
+	}
+	
+	return interpolate(M);
+}
+
+// Calculating orbits https://space.stackexchange.com/questions/8911/determining-orbital-position-at-a-future-point-in-time
+double KeplerTable::solve(double eccentricity, double meanAnomaly) {
+	double M = std::remainder(meanAnomaly, 2 * std::numbers::pi);
+	
+	if (M < 0) {
+		return -solve(eccentricity, -M);
+	}
+	
+	// Kepler's equation is convex on 0 to π, so starting at π converges for all eccentricities below 1
+	double E = eccentricity > 0.8 ? std::numbers::pi : M;
+	
+	for (int i = 0; i < 100; i++) {
+		double dE = (E - eccentricity * std::sin(E) - M) / (1.0 - eccentricity * std::cos(E));
+		E -= dE;
+		
+		if (std::abs(dE) < 1e-15) {
+			break;
+		}
+	}
+	
+	return E;
+}
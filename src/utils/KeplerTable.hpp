@@ -0,0 +1,43 @@
+/*
+ * KeplerTable.hpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: exuvo
+ */
+
+#ifndef SRC_UTILS_KEPLERTABLE_HPP_
+#define SRC_UTILS_KEPLERTABLE_HPP_
+
+#include <stdint.h>
+#include <vector>
+
+// Eccentric anomaly as a function of mean anomaly for one eccentricity, so orbits need no Newton iterations per lookup.
+// Sampled over half an orbit, the other half is mirrored, and evaluated with cubic Hermite interpolation using the
+//  exact derivative dE/dM = 1 / (1 - e cos E). Samples double until the error between them is below TOLERANCE.
+class KeplerTable {
+	public:
+		static constexpr double TOLERANCE = 1e-9; // In radians, about 150m at 1 AU
+		static constexpr uint32_t MAX_SAMPLES = 8192;
+		
+		KeplerTable(double eccentricity);
+		
+		// Mean anomaly in radians of any range, returns the eccentric anomaly in -π to π
+		double eccentricAnomaly(double meanAnomaly) const;
+		
+		uint32_t size() const { return anomalies.size(); }
+		
+		// Newtons method to full double precision, used to build the table. Returns -π to π
+		static double solve(double eccentricity, double meanAnomaly);
+		
+	private:
+		double eccentricity;
+		double step;
+		double inverseStep;
+		std::vector<double> anomalies;
+		std::vector<double> derivatives; // Multiplied by step
+		
+		void build(uint32_t samples);
+		double interpolate(double meanAnomaly) const;
+};
+
+#endif /* SRC_UTILS_KEPLERTABLE_HPP_ */
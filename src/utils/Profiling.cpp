@@ -7,6 +7,37 @@
 
 #include "utils/Profiling.hpp"
 
+std::mutex ProfilerNames::mutex;
+std::array<std::string, ProfilerNames::MAX_NAMES> ProfilerNames::names;
+std::atomic<uint16_t> ProfilerNames::count = 1; // 0 is NONE
+
+uint16_t ProfilerNames::intern(const std::string& name) {
+	std::lock_guard<std::mutex> lock(mutex);
+	uint16_t size = count.load(std::memory_order_relaxed);
+	
+	for (uint16_t id = 1; id < size; id++) {
+		if (names[id] == name) {
+			return id;
+		}
+	}
+	
+	if (size == MAX_NAMES) {
+		throw std::runtime_error("Too many profiler names");
+	}
+	
+	names[size] = name;
+	count.store(size + 1, std::memory_order_release);
+	return size;
+}
+
+const char* ProfilerNames::get(uint16_t id) {
+	if (id >= count.load(std::memory_order_acquire)) {
+		return "?";
+	}
+	
+	return names[id].c_str();
+}
+
 void ProfilerEvents::start(nanoseconds time, std::string name) {
 	events.emplace_back(time, name);
 }
@@ -23,18 +54,31 @@ void ProfilerEvents::start(std::string name) {
 	events.emplace_back(name);
 }
 
+void ProfilerEvents::start(uint16_t nameID) {
+	events.emplace_back(getNanos(), nameID);
+}
+
 void ProfilerEvents::end(nanoseconds time) {
 	events.emplace_back(time);
 }
 
+void ProfilerEvents::metric(const char* name, nanoseconds value) {
+	metrics.emplace_back(value, name);
+}
+
 const ProfilerEvent& ProfilerEvents::operator[](size_t idx) const {
 	return events[idx];
 }
 
+const std::vector<ProfilerEvent>& ProfilerEvents::getMetrics() const {
+	return metrics;
+}
+
 size_t ProfilerEvents::size() const {
 	return events.size();
 }
 
 void ProfilerEvents::clear() {
 	events.clear();
+	metrics.clear();
 }
@@ -8,18 +8,39 @@
 #ifndef SRC_PROFILING_HPP_
 #define SRC_PROFILING_HPP_
 
+#include <array>
+#include <atomic>
 #include <string>
 #include <cstring>
 #include <chrono>
+#include <mutex>
 
 #include "utils/Bag.hpp"
 #include "utils/Utils.hpp"
 
 using namespace std::chrono;
 
+// Names interned once up front so that hot paths can record events by id without copying or allocating strings
+class ProfilerNames {
+	public:
+		static constexpr uint16_t NONE = 0;
+		
+		// Returns the existing id if name was already interned
+		static uint16_t intern(const std::string& name);
+		static const char* get(uint16_t id);
+		
+	private:
+		static constexpr uint16_t MAX_NAMES = 1024;
+		
+		static std::mutex mutex;
+		static std::array<std::string, MAX_NAMES> names;
+		static std::atomic<uint16_t> count; // Names below count are immutable and may be read without locking
+};
+
 class ProfilerEvent {
 	public:
 		nanoseconds time;
+		uint16_t nameID = ProfilerNames::NONE; // Interned name, used instead of name when set
 		char name[50]; // Set to start event, empty to end previous
 		
 		ProfilerEvent(): time(0ns) {};
@@ -42,12 +63,23 @@ class ProfilerEvent {
 			memcpy(name, name_in, len);
 			name[len] = '\0';
 		};
+		ProfilerEvent(nanoseconds time, uint16_t nameID): time(time), nameID(nameID) {
+			name[0] = '\0';
+		};
 		
 		// End
 		ProfilerEvent(nanoseconds time = getNanos()): time(time) {
 			name[0] = '\0';
 		};
 		
+		const char* getName() const {
+			return nameID != ProfilerNames::NONE ? ProfilerNames::get(nameID) : name;
+		}
+		
+		bool isEnd() const {
+			return nameID == ProfilerNames::NONE && name[0] == '\0';
+		}
+		
 //		auto start(const char* name) -> ProfilerEvent& {
 //			return start(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()), name);
 //		}
@@ -88,15 +120,21 @@ class ProfilerEvents {
 		void start(const char* name);
 		void start(const char* name, size_t length);
 		void start(std::string name);
+		void start(uint16_t nameID); // From ProfilerNames::intern
 		void end(nanoseconds time = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()));
 		
+		// Named measurement that is not a timed section, like a latency percentile
+		void metric(const char* name, nanoseconds value);
+		
 		const ProfilerEvent& operator[](size_t idx) const;
+		const std::vector<ProfilerEvent>& getMetrics() const;
 
 		size_t size() const;
 		void clear();
 
 	private:
 		std::vector<ProfilerEvent> events;
+		std::vector<ProfilerEvent> metrics;
 };
 
 #endif /* SRC_PROFILING_HPP_ */
@@ -0,0 +1,116 @@
+/*
+ * TickBarrier.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: exuvo
+ */
+
+#include <algorithm>
+
+#include "utils/TickBarrier.hpp"
+#include "utils/Utils.hpp"
+
+void TickBarrier::init(uint32_t workers) {
+	workerLatencies = std::vector<WorkerLatency>(workers);
+	latencySamples.reserve(LATENCY_SAMPLES);
+	sortedSamples.reserve(LATENCY_SAMPLES);
+}
+
+void TickBarrier::start(uint32_t work) {
+	remaining.store(work, std::memory_order_relaxed);
+	startTime.store(getNanos().count(), std::memory_order_relaxed);
+	epoch.fetch_add(1, std::memory_order_release);
+	epoch.notify_all(); // No syscall if every worker is still spinning
+}
+
+void TickBarrier::stop() {
+	stopped.store(true, std::memory_order_release);
+	
+	remaining.store(0, std::memory_order_release);
+	remaining.notify_all();
+	
+	epoch.fetch_add(1, std::memory_order_release);
+	epoch.notify_all();
+}
+
+bool TickBarrier::waitDone(nanoseconds spinBudget) {
+	const nanoseconds spinUntil = getNanos() + std::min(spinBudget, MAX_SPIN);
+	
+	uint32_t left = remaining.load(std::memory_order_acquire);
+	while (left > 0) {
+		if (getNanos() < spinUntil) {
+			cpuRelax();
+		} else {
+			remaining.wait(left, std::memory_order_acquire);
+		}
+		
+		left = remaining.load(std::memory_order_acquire);
+	}
+	
+	return !isStopped();
+}
+
+uint32_t TickBarrier::waitStart(uint32_t workerIndex, uint32_t lastEpoch) {
+	const nanoseconds spinUntil = getNanos() + nanoseconds(spinBudget.load(std::memory_order_relaxed));
+	
+	uint32_t current = epoch.load(std::memory_order_acquire);
+	while (current == lastEpoch) {
+		if (getNanos() < spinUntil) {
+			cpuRelax();
+		} else {
+			epoch.wait(lastEpoch, std::memory_order_acquire);
+		}
+		
+		current = epoch.load(std::memory_order_acquire);
+	}
+	
+	workerLatencies[workerIndex].latency.store(getNanos().count() - startTime.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	
+	return current;
+}
+
+void TickBarrier::finishOne() {
+	// Never below zero, stop may have dropped the work while this job was running
+	uint32_t left = remaining.load(std::memory_order_relaxed);
+	while (left > 0 && !remaining.compare_exchange_weak(left, left - 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {}
+	
+	if (left == 1) {
+		remaining.notify_one();
+	}
+}
+
+void TickBarrier::setSpinBudget(nanoseconds budget) {
+	spinBudget.store(std::clamp(budget, 0ns, MAX_SPIN).count(), std::memory_order_relaxed);
+}
+
+void TickBarrier::collectLatencies() {
+	for (WorkerLatency& worker : workerLatencies) {
+		int64_t latency = worker.latency.exchange(-1, std::memory_order_relaxed);
+		
+		if (latency >= 0) {
+			if (latencySamples.size() < LATENCY_SAMPLES) {
+				latencySamples.push_back(nanoseconds(latency));
+			} else {
+				latencySamples[latencySampleIndex] = nanoseconds(latency);
+				latencySampleIndex = (latencySampleIndex + 1) % LATENCY_SAMPLES;
+			}
+			
+			unsortedSamples++;
+		}
+	}
+}
+
+nanoseconds TickBarrier::latencyPercentile(uint32_t percentile) {
+	if (latencySamples.empty()) {
+		return 0ns;
+	}
+	
+	if (sortedSamples.empty() || unsortedSamples >= LATENCY_SAMPLES / 16) {
+		sortedSamples = latencySamples;
+		std::sort(sortedSamples.begin(), sortedSamples.end());
+		unsortedSamples = 0;
+	}
+	
+	size_t index = std::min(sortedSamples.size() - 1, (sortedSamples.size() * std::min(percentile, 100u)) / 100);
+	return sortedSamples[index];
+}
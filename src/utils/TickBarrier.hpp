@@ -0,0 +1,69 @@
+/*
+ * TickBarrier.hpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: exuvo
+ */
+
+#ifndef SRC_UTILS_TICKBARRIER_HPP_
+#define SRC_UTILS_TICKBARRIER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+using namespace std::chrono;
+
+// Barrier between one coordinator thread and a pool of workers.
+// The coordinator starts a tick by bumping an epoch counter, workers count down remaining work and the last one wakes the coordinator.
+// Both sides spin for a budget before parking with std::atomic::wait (a futex on linux) so short gaps between ticks avoid syscalls.
+class TickBarrier {
+	public:
+		static constexpr nanoseconds MAX_SPIN = 200us;
+		static constexpr uint32_t LATENCY_SAMPLES = 1024;
+		
+		void init(uint32_t workers);
+		
+		// Coordinator
+		void start(uint32_t work);
+		// Returns false if the barrier was stopped instead of all work finishing
+		bool waitDone(nanoseconds spinBudget);
+		bool isDone() const { return remaining.load(std::memory_order_acquire) == 0; }
+		
+		// Drops the remaining work of the current tick and releases the coordinator and all workers, for good.
+		//  Used on shutdown and when a worker dies so that nobody waits for work that will never finish.
+		void stop();
+		bool isStopped() const { return stopped.load(std::memory_order_acquire); }
+		
+		// Worker, returns the new epoch
+		uint32_t waitStart(uint32_t workerIndex, uint32_t lastEpoch);
+		void finishOne();
+		bool hasWork() const { return remaining.load(std::memory_order_acquire) > 0; }
+		
+		// How long workers spin before parking, set by the coordinator from the expected time between ticks
+		void setSpinBudget(nanoseconds budget);
+		
+		// Moves the wake latencies of the last tick into the sample history, call after waitDone
+		void collectLatencies();
+		// Percentiles are resorted once every LATENCY_SAMPLES / 16 new samples to keep this cheap at high tick rates
+		nanoseconds latencyPercentile(uint32_t percentile);
+		
+	private:
+		alignas(64) std::atomic<uint32_t> epoch = 0;
+		alignas(64) std::atomic<uint32_t> remaining = 0;
+		std::atomic<bool> stopped = false;
+		std::atomic<int64_t> spinBudget = 0;
+		std::atomic<int64_t> startTime = 0;
+		
+		struct alignas(64) WorkerLatency {
+				std::atomic<int64_t> latency = -1; // Written by a worker that may not have taken any work
+		};
+		
+		std::vector<WorkerLatency> workerLatencies;
+		std::vector<nanoseconds> latencySamples;
+		std::vector<nanoseconds> sortedSamples;
+		uint32_t latencySampleIndex = 0;
+		uint32_t unsortedSamples = 0;
+};
+
+#endif /* SRC_UTILS_TICKBARRIER_HPP_ */
@@ -224,6 +224,54 @@ void setThreadPriority(std::thread &thread, ThreadPriority prio) {
 #endif
 }
 
+bool setThreadAffinity(std::thread& thread, uint32_t core) {
+	
+	std::thread::native_handle_type tHandle = thread.native_handle();
+	
+#if (defined _WIN32)
+	
+	DWORD_PTR mask = ((DWORD_PTR) 1) << core;
+	
+	if (!SetThreadAffinityMask(tHandle, mask)) {
+		LOG4CXX_WARN(utilLog, "Failed to set thread affinity to core " << core << ": " << GetLastError());
+		return false;
+	}
+	
+	return true;
+	
+#elif defined __unix__ && !defined __CYGWIN__
+	
+	cpu_set_t cpuset;
+	CPU_ZERO(&cpuset);
+	CPU_SET(core, &cpuset);
+	
+	int err = pthread_setaffinity_np(tHandle, sizeof(cpu_set_t), &cpuset);
+	
+	if (err) {
+		std::ostringstream out;
+		out << "Failed to set thread " << tHandle << " affinity to core " << core << ": ";
+		
+		if (err == EINVAL) {
+			out << "EINVAL The affinity bit mask contains no processors that are currently physically on the system and permitted to the thread.";
+		} else if (err == ESRCH) {
+			out << "ESRCH No thread with the handle " << tHandle << " could be found.";
+		} else {
+			out << std::strerror(err);
+		}
+		
+		LOG4CXX_WARN(utilLog, out.str());
+		return false;
+	}
+	
+	return true;
+	
+#else
+	
+	return false;
+	
+#endif
+}
+
 namespace entt {
 	std::ostream& operator<<(std::ostream& os, const entt::entity& e) {
 		return os << (uint32_t) entt::registry::entity(e) << ":" << (uint32_t) entt::registry::version(e);
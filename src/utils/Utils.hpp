@@ -33,6 +33,7 @@ BETTER_ENUM(ThreadPriority, uint8_t,
 );
 
 void setThreadPriority(std::thread& thread, ThreadPriority prio);
+bool setThreadAffinity(std::thread& thread, uint32_t core);
 
 namespace entt {
 	std::ostream& operator<<(std::ostream& os, const entt::entity& e);
@@ -75,6 +76,15 @@ void vectorAppend(std::unordered_set<T, H>& a, const std::vector<T>& b) {
 nanoseconds getNanos();
 milliseconds getMillis();
 
+// Hint to the cpu that we are busy waiting
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield");
+#endif
+}
+
 //std::string nanoToString(uint64_t time);
 //std::string nanoToMicroString(uint64_t time);
 std::string milliToString(uint64_t time);
@@ -131,6 +131,10 @@ int QuadtreeAABB::insert(uint32_t id, int32_t x1, int32_t y1, int32_t x2, int32_
     const QuadAABBElt new_elt = {id, {x1, y1, x2, y2}};
     const int element = elts.insert(new_elt);
     node_insert(*this, root_data(), element);
+
+    if (journaling)
+        journal.push_back({QuadAABBOp::Type::INSERT, id, {x1, y1, x2, y2}, element});
+
     return element;
 }
 
@@ -164,6 +168,9 @@ void QuadtreeAABB::remove(int32_t element)
     }
     // Remove the element.
     elts.erase(element);
+
+    if (journaling)
+        journal.push_back({QuadAABBOp::Type::REMOVE, 0, {}, element});
 }
 
 SmallList<uint32_t> QuadtreeAABB::query(const std::array<int32_t, 4> rect, int32_t omit_element)
@@ -241,6 +248,9 @@ bool QuadtreeAABB::cleanup()
         }
     }
     
+    if (changed && journaling)
+        journal.push_back({QuadAABBOp::Type::CLEANUP});
+
     return changed;
 }
 
@@ -333,6 +343,9 @@ bool QuadtreeAABB::cleanupFull()
         }
     }
     
+    if (changed && journaling)
+        journal.push_back({QuadAABBOp::Type::CLEANUP_FULL});
+
     return changed;
 }
 
@@ -371,3 +384,23 @@ void QuadtreeAABB::traverse(void* user_data, QuadtreeAABBNodeFunc* branch, Quadt
 		}
 	}
 }
+
+void QuadtreeAABB::replay(const std::vector<QuadAABBOp>& ops) {
+	bool wasJournaling = journaling;
+	journaling = false;
+	
+	for (const QuadAABBOp& op : ops) {
+		switch (op.type) {
+			case QuadAABBOp::Type::INSERT: {
+				[[maybe_unused]] int32_t element = insert(op.id, op.ltrb[0], op.ltrb[1], op.ltrb[2], op.ltrb[3]);
+				assert(element == op.element);
+				break;
+			}
+			case QuadAABBOp::Type::REMOVE: remove(op.element); break;
+			case QuadAABBOp::Type::CLEANUP: cleanup(); break;
+			case QuadAABBOp::Type::CLEANUP_FULL: cleanupFull(); break;
+		}
+	}
+	
+	journaling = wasJournaling;
+}
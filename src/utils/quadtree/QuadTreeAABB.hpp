@@ -8,6 +8,7 @@
 #define QUADTREE_AABB_HPP
 
 #include <stdint.h>
+#include <vector>
 
 #include "utils/SmallList.hpp"
 #include "utils/FreeList.hpp"
@@ -59,6 +60,19 @@ struct QuadAABBNodeData
 };
 typedef SmallList<QuadAABBNodeData> QuadAABBNodeList;
 
+// An edit recorded in the journal of a tree.
+struct QuadAABBOp
+{
+    enum class Type : uint8_t { INSERT, REMOVE, CLEANUP, CLEANUP_FULL };
+
+    Type type;
+    uint32_t id;
+    int32_t ltrb[4];
+
+    // Element index returned by insert or passed to remove.
+    int32_t element;
+};
+
 struct QuadtreeAABB;
 typedef void QuadtreeAABBNodeFunc(QuadtreeAABB* qt, void* user_data, int32_t node, uint8_t depth, int32_t mx, int32_t my, int32_t sx, int32_t sy);
 
@@ -89,6 +103,14 @@ struct QuadtreeAABB
     // Traverses all the nodes in the tree, calling 'branch' for branch nodes and 'leaf' for leaf nodes.
     void traverse(void* user_data, QuadtreeAABBNodeFunc* branch, QuadtreeAABBNodeFunc* leaf);
 
+    // Applies edits journaled by a tree that was identical to this one when they were made.
+    // Every step is deterministic so this ends up identical again, including element indices.
+    void replay(const std::vector<QuadAABBOp>& ops);
+
+    // Records every edit to journal while set so a copy of the tree can be kept in sync with replay.
+    bool journaling = false;
+    std::vector<QuadAABBOp> journal;
+
     // Stores all the nodes in the quadtree. The first node in this
     // sequence is always the root.
     SmallList<QuadAABBNode> nodes;
@@ -170,6 +170,10 @@ int32_t QuadtreePoint::insert(uint32_t id, int32_t x, int32_t y)
     const QuadPointElt new_elt = {id, x, y};
     const int element = elts.insert(new_elt);
     node_insert(*this, root_data(), element);
+
+    if (journaling)
+        journal.push_back({QuadPointOp::Type::INSERT, id, x, y, element});
+
     return element;
 }
 
@@ -200,6 +204,9 @@ void QuadtreePoint::remove(int32_t element)
 		
     // Remove the element.
     elts.erase(element);
+
+    if (journaling)
+        journal.push_back({QuadPointOp::Type::REMOVE, 0, 0, 0, element});
 }
 
 SmallList<uint32_t> QuadtreePoint::query(const std::array<int32_t, 4> rect, int32_t omit_element)
@@ -274,6 +281,9 @@ bool QuadtreePoint::cleanup()
         }
     }
     
+    if (changed && journaling)
+        journal.push_back({QuadPointOp::Type::CLEANUP});
+
     return changed;
 }
 
@@ -366,6 +376,9 @@ bool QuadtreePoint::cleanupFull()
         }
     }
     
+    if (changed && journaling)
+        journal.push_back({QuadPointOp::Type::CLEANUP_FULL});
+
     return changed;
 }
 
@@ -403,3 +416,23 @@ void QuadtreePoint::traverse(void* user_data, QuadtreePointNodeFunc* branch, Qua
 		}
 	}
 }
+
+void QuadtreePoint::replay(const std::vector<QuadPointOp>& ops) {
+	bool wasJournaling = journaling;
+	journaling = false;
+	
+	for (const QuadPointOp& op : ops) {
+		switch (op.type) {
+			case QuadPointOp::Type::INSERT: {
+				[[maybe_unused]] int32_t element = insert(op.id, op.x, op.y);
+				assert(element == op.element);
+				break;
+			}
+			case QuadPointOp::Type::REMOVE: remove(op.element); break;
+			case QuadPointOp::Type::CLEANUP: cleanup(); break;
+			case QuadPointOp::Type::CLEANUP_FULL: cleanupFull(); break;
+		}
+	}
+	
+	journaling = wasJournaling;
+}
@@ -5,6 +5,7 @@
 #define QUADTREE_POINT_HPP
 
 #include <stdint.h>
+#include <vector>
 
 #include "utils/SmallList.hpp"
 #include "utils/FreeList.hpp"
@@ -57,6 +58,20 @@ struct QuadPointNodeData
 };
 typedef SmallList<QuadPointNodeData> QuadPointNodeList;
 
+// An edit recorded in the journal of a tree.
+struct QuadPointOp
+{
+    enum class Type : uint8_t { INSERT, REMOVE, CLEANUP, CLEANUP_FULL };
+
+    Type type;
+    uint32_t id;
+    int32_t x;
+    int32_t y;
+
+    // Element index returned by insert or passed to remove.
+    int32_t element;
+};
+
 // Function signature used for traversing a tree node.
 struct QuadtreePoint;
 typedef void QuadtreePointNodeFunc(QuadtreePoint* qt, void* user_data, int32_t node, uint8_t depth, int32_t mx, int32_t my, int32_t sx, int32_t sy);
@@ -88,6 +103,14 @@ struct QuadtreePoint
     // Traverses all the nodes in the tree, calling 'branch' for branch nodes and 'leaf' for leaf nodes.
     void traverse(void* user_data, QuadtreePointNodeFunc* branch, QuadtreePointNodeFunc* leaf);
 
+    // Applies edits journaled by a tree that was identical to this one when they were made.
+    // Every step is deterministic so this ends up identical again, including element indices.
+    void replay(const std::vector<QuadPointOp>& ops);
+
+    // Records every edit to journal while set so a copy of the tree can be kept in sync with replay.
+    bool journaling = false;
+    std::vector<QuadPointOp> journal;
+
     // Stores all the nodes in the quadtree. The first node in this
     // sequence is always the root.
     SmallList<QuadPointNode> nodes;